@@ -0,0 +1,1047 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Audio data path: USB OUT endpoint -> circular sound buffers -> VDAC/I2S DMA.
+*
+*******************************************************************************/
+#include "audio_path.h"
+#include "profiler.h"
+#include <string.h>
+
+/* Received USB packet buffer. */
+#if (USBFS_EP_MANAGEMENT_DMA_AUTO)
+uint8 rawPacket[USB_BUF_SIZE] CY_ALIGN(4);
+#else
+uint8 tmpEpBuf[USB_BUF_SIZE] CY_ALIGN(4);
+#endif
+
+#if (AUDIO_ASYNC_MODE)
+/* Feedback endpoint buffer. */
+static uint8 fbBuf[FB_SIZE];
+#endif
+
+/* Circular buffer for audio stream. */
+#if (USE_VDAC_OUTPUT)
+uint8 soundBuffer_L[BUFFER_SIZE];
+uint8 soundBuffer_R[BUFFER_SIZE];
+#else
+/* Mid-scale level for the idle VDAC DMA, which only paces VdacDmaDone. */
+static uint8 vdacIdle = 128u;
+#endif
+#if (USE_I2S_OUTPUT)
+uint8 soundBuffer_I2S[I2S_BUFFER_SIZE] CY_ALIGN(4);
+#endif
+
+/* Active ring region. */
+AUDIO_RING soundRing = {0u, 0u, BUFFER_SIZE - 1u};
+uint8 numOfBuffers = NUM_OF_BUFFERS;
+uint16 transferSize = TRANSFER_SIZE;
+uint8 transferSizeLog2 = TRANSFER_SIZE_LOG2;
+uint16 bufferSize = BUFFER_SIZE;
+
+/* Latency profiles: chunks in the ring and chunk size in packets (0: TRANSFER_SIZE). */
+static const uint8 latencyChunks[LATENCY_PROFILES] = {NUM_OF_BUFFERS, 8u, 4u};
+static const uint8 latencyPackets[LATENCY_PROFILES] = {2u, 1u, 1u};
+#if (AUDIO_CONCEAL)
+/* Whether under-runs are concealed, or the DMAs stopped. */
+static const uint8 latencyConceal[LATENCY_PROFILES] = {1u, 1u, 0u};
+#endif
+
+/* Operation flag. */
+volatile uint8 flag = 0u;
+
+/* Receive stage status. */
+volatile uint8 rxPacketCount = 0u;
+volatile uint8 rxDropCount = 0u;
+volatile uint16 rxOutIndexVDAC = 0u;
+volatile uint16 rxOutIndexI2S = 0u;
+volatile uint16 rxDist = 0u;
+volatile uint16 rxDist0 = 0u;
+
+#if (AUDIO_CONCEAL)
+/* Under-run concealment, when concealOn. VdacDmaDone conceals the ring up to
+ * concealEnd and bumps concealSeq; the receive stage resumes there and
+ * acknowledges it with concealAck. concealing is set while the chunks sent
+ * are concealed, fading out concealL/R over the concealFade frames left, and
+ * fadeInCount counts the frames of the fade-in written. */
+static uint8 concealOn = 1u;
+static volatile uint16 concealEnd = 0u;
+static volatile uint8 concealSeq = 0u;
+static volatile uint8 concealAck = 0u;
+static uint8 concealing = 0u;
+static uint32 concealL;
+static uint32 concealR;
+static uint16 concealFade;
+static uint16 fadeInCount = AUDIO_FADE_FRAMES;
+#endif
+
+/* Variables for VDACoutDMA. */
+uint8 VdacOutDmaCh_L;
+uint8 VdacOutDmaCh_R;
+uint8 VdacOutDmaTd_L[NUM_OF_BUFFERS];
+uint8 VdacOutDmaTd_R[NUM_OF_BUFFERS];
+
+/* DMA Configuration for VDACoutDMA (Memory to VDAC) */
+#define VDAC_DMA_BYTES_PER_BURST    (1u)
+#define VDAC_DMA_REQUEST_PER_BURST  (1u)
+#define VDAC_DMA_TD_TERMOUT_EN      (VdacDma_L__TD_TERMOUT_EN)
+#define VDAC_DMA_DST_BASE           (CYDEV_PERIPH_BASE)
+#if (USE_VDAC_OUTPUT)
+#define VDAC_DMA_SRC_BASE_L         (CY_PSOC5LP) ? ((uint32) soundBuffer_L) : (CYDEV_SRAM_BASE)
+#define VDAC_DMA_SRC_BASE_R         (CY_PSOC5LP) ? ((uint32) soundBuffer_R) : (CYDEV_SRAM_BASE)
+#define VDAC_DMA_TD_INC             (TD_INC_SRC_ADR)
+#define VDAC_DMA_SRC_L(i)           (&soundBuffer_L[(i) * transferSize])
+#else
+#define VDAC_DMA_SRC_BASE_L         (CY_PSOC5LP) ? ((uint32) &vdacIdle) : (CYDEV_SRAM_BASE)
+#define VDAC_DMA_TD_INC             (0u)
+#define VDAC_DMA_SRC_L(i)           (&vdacIdle)
+#endif
+#define VDAC_DMA_ENABLE_PRESERVE_TD (1u)
+
+/* Variables for I2S_DMA. */
+uint8 I2SDmaCh;
+uint8 I2SDmaTd[NUM_OF_BUFFERS];
+
+/* DMA Configuration for I2S_DMA (Memory to I2S) */
+#define I2S_DMA_BYTES_PER_BURST    (1u)
+#define I2S_DMA_REQUEST_PER_BURST  (1u)
+#define I2S_DMA_TD_TERMOUT_EN      (I2S_DMA__TD_TERMOUT_EN)
+#define I2S_DMA_DST_BASE           (CYDEV_PERIPH_BASE)
+#define I2S_DMA_SRC_BASE           (CY_PSOC5LP) ? ((uint32) soundBuffer_I2S) : (CYDEV_SRAM_BASE)
+#define I2S_DMA_ENABLE_PRESERVE_TD (1u)
+
+/* Chunk index of each TD handle, TD_NOT_CHAINED for TDs of other DMAs. */
+#define TD_NOT_CHAINED             (0xFFu)
+static uint8 tdChunk[CY_DMA_NUMBEROF_TDS];
+
+/* I2S DMA byte count to frames, a shift unless the frame is 6 bytes (24-bit). */
+#if (I2S_DATA_SIZE == 4u)
+#define I2S_FRAMES(bytes)          ((bytes) >> 2)
+#elif (I2S_DATA_SIZE == 8u)
+#define I2S_FRAMES(bytes)          ((bytes) >> 3)
+#else
+#define I2S_FRAMES(bytes)          ((bytes) / I2S_DATA_SIZE)
+#endif
+
+/* Swap bytes in each halfword / in a word. GCC emits a single REV16 / REV. */
+#define REV16(x)                   ((((x) & 0x00FF00FFu) << 8) | (((x) >> 8) & 0x00FF00FFu))
+#define REV32(x)                   REV16(((x) << 16) | ((x) >> 16))
+
+/* Conversion kernel and packet frame size for the active alternate setting. */
+static void convertFrames16(const uint8 *src, uint16 dst, uint16 n);
+static void (*convertFrames)(const uint8 *src, uint16 dst, uint16 n) = &convertFrames16;
+static uint8 frameBytes = AUDIO_CH*2u;
+
+/*******************************************************************************
+*  Chain numOfBuffers transfer descriptors of transferSize frames into cyclic
+*  buffers over the active ring region and start the DMAs from the 1st one.
+*******************************************************************************/
+static void buildTdChains() {
+    uint8 i;
+
+    /* Configure DMA transfer descriptors. */
+    for (i = 0u; i < numOfBuffers; ++i) {
+        /* Chain current and next DMA transfer descriptors to be in row. */
+        /* Last and 1st DMA transfer descriptors to make cyclic buffer. */
+        CyDmaTdSetConfiguration(VdacOutDmaTd_L[i], transferSize, VdacOutDmaTd_L[(i + 1u)%numOfBuffers],
+                                (VDAC_DMA_TD_INC | VDAC_DMA_TD_TERMOUT_EN));
+        CyDmaTdSetAddress(VdacOutDmaTd_L[i], LO16((uint32) VDAC_DMA_SRC_L(i)),
+                          LO16((uint32) VDAC8_L_Data_PTR));
+#if (USE_VDAC_OUTPUT)
+        CyDmaTdSetConfiguration(VdacOutDmaTd_R[i], transferSize, VdacOutDmaTd_R[(i + 1u)%numOfBuffers],
+                                (TD_INC_SRC_ADR));
+        CyDmaTdSetAddress(VdacOutDmaTd_R[i], LO16((uint32) &soundBuffer_R[i * transferSize]),
+                          LO16((uint32) VDAC8_R_Data_PTR));
+#endif
+#if (USE_I2S_OUTPUT)
+        CyDmaTdSetConfiguration(I2SDmaTd[i], transferSize*I2S_DATA_SIZE, I2SDmaTd[(i + 1u)%numOfBuffers],
+                                (TD_INC_SRC_ADR));
+        CyDmaTdSetAddress(I2SDmaTd[i], LO16((uint32) &soundBuffer_I2S[i * transferSize*I2S_DATA_SIZE]),
+                          LO16((uint32) I2S_TX_CH0_F0_PTR));
+#endif
+    }
+
+    /* Set 1st transfer descriptor to execute. */
+    CyDmaChSetInitialTd(VdacOutDmaCh_L, VdacOutDmaTd_L[0u]);
+#if (USE_VDAC_OUTPUT)
+    CyDmaChSetInitialTd(VdacOutDmaCh_R, VdacOutDmaTd_R[0u]);
+#endif
+#if (USE_I2S_OUTPUT)
+    CyDmaChSetInitialTd(I2SDmaCh, I2SDmaTd[0u]);
+#endif
+
+    /* Start DMA operation. */
+    CyDmaChEnable(VdacOutDmaCh_L, VDAC_DMA_ENABLE_PRESERVE_TD);
+#if (USE_VDAC_OUTPUT)
+    CyDmaChEnable(VdacOutDmaCh_R, VDAC_DMA_ENABLE_PRESERVE_TD);
+#endif
+#if (USE_I2S_OUTPUT)
+    CyDmaChEnable(I2SDmaCh, I2S_DMA_ENABLE_PRESERVE_TD);
+#endif
+}
+
+/*******************************************************************************
+* Initialize (1)VdacDma_L, (2)VdacDma_R and (3)I2S_DMA. Without the VDAC output
+* VdacDma_L still runs from a fixed mid-scale byte to pace VdacDmaDone.
+* Transfer descriptors are allocated for NUM_OF_BUFFERS chunks, of which the
+* latency profile uses numOfBuffers.
+*******************************************************************************/
+void initDMAs() {
+    uint8 i;
+
+    /* Initialize DMA channel. */
+    VdacOutDmaCh_L = VdacDma_L_DmaInitialize(VDAC_DMA_BYTES_PER_BURST, VDAC_DMA_REQUEST_PER_BURST,
+                                             HI16(VDAC_DMA_SRC_BASE_L), HI16(VDAC_DMA_DST_BASE));
+#if (USE_VDAC_OUTPUT)
+    VdacOutDmaCh_R = VdacDma_R_DmaInitialize(VDAC_DMA_BYTES_PER_BURST, VDAC_DMA_REQUEST_PER_BURST,
+                                             HI16(VDAC_DMA_SRC_BASE_R), HI16(VDAC_DMA_DST_BASE));
+#endif
+#if (USE_I2S_OUTPUT)
+    I2SDmaCh = I2S_DMA_DmaInitialize(I2S_DMA_BYTES_PER_BURST, I2S_DMA_REQUEST_PER_BURST,
+                                     HI16(I2S_DMA_SRC_BASE), HI16(I2S_DMA_DST_BASE));
+#endif
+
+    /* Allocate transfer descriptors for each buffer chunk and map them back to it. */
+    memset(tdChunk, TD_NOT_CHAINED, sizeof(tdChunk));
+    for (i = 0u; i < NUM_OF_BUFFERS; ++i) {
+        VdacOutDmaTd_L[i] = CyDmaTdAllocate();
+        tdChunk[VdacOutDmaTd_L[i]] = i;
+#if (USE_VDAC_OUTPUT)
+        VdacOutDmaTd_R[i] = CyDmaTdAllocate();
+        tdChunk[VdacOutDmaTd_R[i]] = i;
+#endif
+#if (USE_I2S_OUTPUT)
+        I2SDmaTd[i] = CyDmaTdAllocate();
+        tdChunk[I2SDmaTd[i]] = i;
+#endif
+    }
+
+    buildTdChains();
+}
+
+/*******************************************************************************
+*  Select latency profile for sampling rate fs (0: not known yet). The active
+*  ring region is resized, the sound buffers are emptied and the TD chains are
+*  rebuilt. BitClk must be stopped, the DMAs restart from the 1st chunk once it
+*  is started again.
+*******************************************************************************/
+void setLatencyProfile(uint8 profile, uint32 fs) {
+    uint16 size = TRANSFER_SIZE;
+    uint8 sizeLog2 = TRANSFER_SIZE_LOG2;
+    uint16 frames;
+    uint8 intr;
+
+    if (profile >= LATENCY_PROFILES) {
+        profile = LATENCY_PROFILE_DEEP;
+    }
+
+    if ((0u != latencyPackets[profile]) && (0u != fs)) {
+        /* Largest packet for fs, e.g. 45 frames at 44.1kHz, rounded up to a power of two. */
+        frames = latencyPackets[profile] * ((fs + 999u)/1000u + AUDIO_ASYNC_MODE);
+        while (size/2u >= frames) {
+            size /= 2u;
+            sizeLog2--;
+        }
+    }
+
+    intr = CyEnterCriticalSection();
+
+    /* Stop DMAs and discard requests and completion events already raised. */
+    CyDmaChDisable(VdacOutDmaCh_L);
+    CyDmaClearPendingDrq(VdacOutDmaCh_L);
+#if (USE_VDAC_OUTPUT)
+    CyDmaChDisable(VdacOutDmaCh_R);
+    CyDmaClearPendingDrq(VdacOutDmaCh_R);
+#endif
+#if (USE_I2S_OUTPUT)
+    CyDmaChDisable(I2SDmaCh);
+    CyDmaClearPendingDrq(I2SDmaCh);
+
+    /* Drop a partial frame left in the FIFO to keep the channels aligned. */
+    I2S_DisableTx();
+    I2S_ClearTxFIFO();
+    I2S_EnableTx();
+#endif
+    VdacDmaDone_ClearPending();
+
+    numOfBuffers = latencyChunks[profile];
+    transferSize = size;
+    transferSizeLog2 = sizeLog2;
+    bufferSize = size * numOfBuffers;
+#if (AUDIO_CONCEAL)
+    resetConceal();
+    concealOn = latencyConceal[profile];
+#endif
+    ringInit(&soundRing, bufferSize);
+
+    buildTdChains();
+
+    CyExitCriticalSection(intr);
+}
+
+/*******************************************************************************
+*  Current TD of DMA channel ch and the bytes it has left. The TD is read again
+*  to pair the count with it when the DMA moves on in between.
+*******************************************************************************/
+static uint8 getDmaTd(uint8 ch, uint16 *count) {
+    uint8 td;
+    uint8 check;
+
+    CyDmaChStatus(ch, &td, NULL);
+    for (;;) {
+        CyDmaTdGetConfiguration(td, count, NULL, NULL);
+        CyDmaChStatus(ch, &check, NULL);
+        if (check == td) {
+            return td;
+        }
+        td = check;
+    }
+}
+
+/*******************************************************************************
+*  Frame position in the ring of the end of td's chunk, 0 for a TD out of the
+*  chains.
+*******************************************************************************/
+static CY_INLINE uint16 tdChunkEnd(uint8 td) {
+    uint8 chunk = tdChunk[td];
+
+    return (TD_NOT_CHAINED == chunk) ? 0u : (uint16)((chunk + 1u) << transferSizeLog2);
+}
+
+/*******************************************************************************
+*  Get current VDAC and I2S DMA transfer points in O(1). The channels are
+*  sampled back to back with interrupts disabled, so they are consistent with
+*  each other and with the ring indices.
+*******************************************************************************/
+void getOutIndex(DMA_POSITION *pos) {
+    uint16 count;
+    uint16 end;
+    uint8 intr = CyEnterCriticalSection();
+
+    end = tdChunkEnd(getDmaTd(VdacOutDmaCh_L, &count));
+    pos->vdacL = (0u == end) ? 0u : (uint16)(end - count);
+#if (USE_VDAC_OUTPUT)
+    end = tdChunkEnd(getDmaTd(VdacOutDmaCh_R, &count));
+    pos->vdacR = (0u == end) ? 0u : (uint16)(end - count);
+#else
+    pos->vdacR = pos->vdacL;
+#endif
+#if (USE_I2S_OUTPUT)
+    end = tdChunkEnd(getDmaTd(I2SDmaCh, &count));
+    pos->i2s = (0u == end) ? 0u : (uint16)(end - I2S_FRAMES(count + I2S_DATA_SIZE - 1u));
+#else
+    pos->i2s = pos->vdacL;
+#endif
+
+    CyExitCriticalSection(intr);
+}
+
+/*******************************************************************************
+*  Enable the OUT endpoint to receive the next packet. With automatic DMA
+*  management the endpoint DMA is also pointed at rawPacket.
+*******************************************************************************/
+void enableOutPacket() {
+#if (USBFS_EP_MANAGEMENT_DMA_AUTO)
+    /* Set the endpoint DMA destination. No data is moved here. */
+    USBFS_ReadOutEP(OUT_EP_NUM, rawPacket, USB_BUF_SIZE);
+#endif
+
+    /* Enable OUT endpoint to receive data from host. */
+    USBFS_EnableOutEP(OUT_EP_NUM);
+}
+
+/*******************************************************************************
+*  Take a received packet from the OUT endpoint. Returns the packet data
+*  (32-bit aligned) and its size in bytes in *size.
+*
+*  Manual DMA: the packet is copied into tmpEpBuf and the endpoint re-armed.
+*  Automatic DMA: the endpoint DMA has already written the packet into
+*  rawPacket, where it is used in place. The endpoint stays disabled until
+*  the caller has converted the packet and calls enableOutPacket().
+*******************************************************************************/
+const uint8 *readOutPacket(uint16 *size) {
+#if (USBFS_EP_MANAGEMENT_DMA_AUTO)
+    /* Aquire received data size. */
+    *size = USBFS_GetEPCount(OUT_EP_NUM);
+
+    return rawPacket;
+#else
+    /* Aquire received data size. */
+    *size = USBFS_GetEPCount(OUT_EP_NUM);
+
+    /* Trigger DMA to copy data from OUT endpoint buffer. */
+    USBFS_ReadOutEP(OUT_EP_NUM, tmpEpBuf, *size);
+
+    /* Wait until DMA completes copying data from OUT endpoint buffer. */
+    while (USBFS_OUT_BUFFER_FULL == USBFS_GetEPState(OUT_EP_NUM)) ;
+
+    /* Enable OUT endpoint to receive data from host. */
+    enableOutPacket();
+
+    return tmpEpBuf;
+#endif
+}
+
+/*******************************************************************************
+*  Store one frame of left-aligned 32-bit samples into the I2S buffer, each
+*  sample MSB first with I2S_DATA_BITS bits. Returns the next frame position.
+*  For 16-bit I2S the frame is a single REV16 of [L, R] upper halfwords.
+*******************************************************************************/
+static CY_INLINE uint8 *storeI2SFrame(uint8 *i2s, uint32 l, uint32 r) {
+#if (I2S_DATA_BITS == 16)
+    *(uint32 *)i2s = REV16((l >> 16) | (r & 0xFFFF0000u));
+#elif (I2S_DATA_BITS == 24)
+    i2s[0] = (uint8)(l >> 24);
+    i2s[1] = (uint8)(l >> 16);
+    i2s[2] = (uint8)(l >> 8);
+    i2s[3] = (uint8)(r >> 24);
+    i2s[4] = (uint8)(r >> 16);
+    i2s[5] = (uint8)(r >> 8);
+#else
+    ((uint32 *)i2s)[0] = REV32(l);
+    ((uint32 *)i2s)[1] = REV32(r);
+#endif
+
+    return i2s + I2S_DATA_SIZE;
+}
+
+#if (VDAC_NOISE_SHAPING)
+/*
+ * Noise shaper. The quantization error is fed back through the noise transfer
+ * function 1 - A*z^-1 + A*z^-2 - z^-3 (A = 2cos(w0)+1), which has zeros at DC
+ * and at w0 around 15kHz. Against truncation it raises the in-band SNR by 5 to
+ * 8dB at 88.2kHz, 6 to 10dB at 96kHz and over 20dB at 176.4/192kHz
+ * (host/tests/test_vdac_shaper). Below 88.2kHz there is no room above the
+ * audio band, and TPDF dither alone costs 4 to 5dB against truncation, so the
+ * samples are truncated as without the switch.
+ */
+#define VDAC_NTF_Q                  (12u)
+#define VDAC_ERR_LIMIT              (512)
+static const uint32 vdacNtfFs[] = {88200u, 96000u, 176400u, 192000u};
+static const int16 vdacNtfA[] = {7911, 8535, 11071, 11257};
+
+static int32 ntfA = 0;          /* A [Q12] */
+static int32 ntfC = 0;          /* z^-3 tap, 0 for truncation. */
+static int32 vdacErr[AUDIO_CH][3];
+static uint32 ditherSeed = 1u;
+
+/*******************************************************************************
+*  Select the noise shaper for sampling rate fs and clear its state.
+*******************************************************************************/
+void setVdacShaper(uint32 fs) {
+    uint8 i;
+
+    ntfA = 0;
+    ntfC = 0;
+    for (i = 0u; i < sizeof(vdacNtfFs)/sizeof(vdacNtfFs[0]); i++) {
+        if (fs >= vdacNtfFs[i]) {
+            ntfA = vdacNtfA[i];
+            ntfC = 1;
+        }
+    }
+    memset(vdacErr, 0, sizeof(vdacErr));
+}
+
+/*******************************************************************************
+*  Requantize a left-aligned 32-bit sample to the unsigned 8-bit VDAC code with
+*  TPDF dither of +/-1 LSB and error feedback, or truncate it when no shaper
+*  is selected. e holds the channel's last three quantization errors [16-bit
+*  LSB].
+*******************************************************************************/
+static CY_INLINE uint8 vdacSample(uint32 s, int32 *e) {
+    int32 u = (int32)s >> 16;
+    int32 q;
+    uint32 r;
+
+    if (0 == ntfC) {
+        return (uint8)(s >> 24) ^ 0x80u;
+    }
+
+    u -= ((ntfA*(e[0] - e[1])) >> VDAC_NTF_Q) + ntfC*e[2];
+
+    /* Sum of two uniform bytes from one LCG step. */
+    ditherSeed = ditherSeed*1664525u + 1013904223u;
+    r = ditherSeed >> 16;
+    q = (u + (int32)(r & 0xFFu) + (int32)(r >> 8) - 255 + 128) >> 8;
+    q = (q > 127) ? 127 : q;
+    q = (q < -128) ? -128 : q;
+
+    /* Limit the error on clipping to keep the loop stable. */
+    e[2] = e[1];
+    e[1] = e[0];
+    e[0] = q*256 - u;
+    e[0] = (e[0] > VDAC_ERR_LIMIT) ? VDAC_ERR_LIMIT : e[0];
+    e[0] = (e[0] < -VDAC_ERR_LIMIT) ? -VDAC_ERR_LIMIT : e[0];
+
+    return (uint8)(q + 128);
+}
+#else
+/* Truncate a left-aligned 32-bit sample to the unsigned 8-bit VDAC code. */
+#define vdacSample(s, e)            ((uint8)((s) >> 24) ^ 0x80u)
+#endif
+
+#if (AUDIO_LEVEL_METER)
+/* Level accumulators, merged by the kernels and read by getLevels(). */
+static uint16 levelPeak[AUDIO_CH];
+static uint64 levelSumSq[AUDIO_CH];
+static uint32 levelFrames = 0u;
+
+/*******************************************************************************
+*  Add a left-aligned 32-bit sample to a channel's peak magnitude and sum of
+*  squares of its top 16 bits.
+*******************************************************************************/
+static CY_INLINE void meterSample(uint32 s, uint32 *peak, uint64 *sumSq) {
+    int32 v = (int32)s >> 16;
+    uint32 a = (uint32)((v < 0) ? -v : v);
+
+    *peak = (a > *peak) ? a : *peak;
+    *sumSq += (uint32)(v*v);
+}
+#endif
+
+/* Write positions in the sound buffers, and the levels of the frames stored. */
+typedef struct {
+#if (USE_I2S_OUTPUT)
+    uint8 *i2s;
+#endif
+#if (USE_VDAC_OUTPUT)
+    uint8 *l;
+    uint8 *r;
+#endif
+#if (AUDIO_LEVEL_METER)
+    uint32 peakL;
+    uint32 peakR;
+    uint64 sumSqL;
+    uint64 sumSqR;
+#endif
+} FRAME_PTR;
+
+/*******************************************************************************
+*  Point p at frame index dst of the sound buffers.
+*******************************************************************************/
+static CY_INLINE void initFramePtr(FRAME_PTR *p, uint16 dst) {
+#if (USE_I2S_OUTPUT)
+    p->i2s = &soundBuffer_I2S[dst*I2S_DATA_SIZE];
+#endif
+#if (USE_VDAC_OUTPUT)
+    p->l = &soundBuffer_L[dst];
+    p->r = &soundBuffer_R[dst];
+#endif
+#if (AUDIO_LEVEL_METER)
+    p->peakL = 0u;
+    p->peakR = 0u;
+    p->sumSqL = 0u;
+    p->sumSqR = 0u;
+#endif
+}
+
+/*******************************************************************************
+*  Store one frame of left-aligned 32-bit samples into the enabled outputs'
+*  sound buffers and advance p.
+*******************************************************************************/
+static CY_INLINE void storeFrame(FRAME_PTR *p, uint32 l, uint32 r) {
+#if (USE_I2S_OUTPUT)
+    p->i2s = storeI2SFrame(p->i2s, l, r);
+#endif
+#if (USE_VDAC_OUTPUT)
+    *p->l++ = vdacSample(l, vdacErr[0]);
+    *p->r++ = vdacSample(r, vdacErr[1]);
+#endif
+#if (AUDIO_LEVEL_METER)
+    meterSample(l, &p->peakL, &p->sumSqL);
+    meterSample(r, &p->peakR, &p->sumSqR);
+#endif
+}
+
+/*******************************************************************************
+*  Merge the levels of the frames stored through p. Called once per kernel run.
+*******************************************************************************/
+static CY_INLINE void storeLevels(const FRAME_PTR *p) {
+#if (AUDIO_LEVEL_METER)
+    levelPeak[0] = (p->peakL > levelPeak[0]) ? (uint16)p->peakL : levelPeak[0];
+    levelPeak[1] = (p->peakR > levelPeak[1]) ? (uint16)p->peakR : levelPeak[1];
+    levelSumSq[0] += p->sumSqL;
+    levelSumSq[1] += p->sumSqR;
+#else
+    (void)p;
+#endif
+}
+
+/*******************************************************************************
+*  Convert n stereo frames from src into the buffers at frame index dst.
+*  Samples are widened to left-aligned 32-bit words, so the I2S frames carry
+*  as many bits as I2S_DATA_BITS allows and the VDAC bytes are requantized by
+*  vdacSample().
+*******************************************************************************/
+/* 16-bit: one 32-bit word holds a whole frame [L lo, L hi, R lo, R hi]. */
+static void convertFrames16(const uint8 *src, uint16 dst, uint16 n) {
+    const uint32 *w = (const uint32 *)src;
+    FRAME_PTR p;
+    uint32 l;
+    uint32 r;
+
+    initFramePtr(&p, dst);
+
+    while (n-- > 0u) {
+        l = *w << 16;
+        r = *w++ & 0xFFFF0000u;
+        storeFrame(&p, l, r);
+    }
+    storeLevels(&p);
+}
+
+#if (AUDIO_WIDE_FORMATS)
+/* 24-bit: 3-byte packed samples, so the frames are not word aligned. */
+static void convertFrames24(const uint8 *src, uint16 dst, uint16 n) {
+    FRAME_PTR p;
+    uint32 l;
+    uint32 r;
+
+    initFramePtr(&p, dst);
+
+    while (n-- > 0u) {
+        l = ((uint32)src[0] << 8) | ((uint32)src[1] << 16) | ((uint32)src[2] << 24);
+        r = ((uint32)src[3] << 8) | ((uint32)src[4] << 16) | ((uint32)src[5] << 24);
+        src += 6u;
+        storeFrame(&p, l, r);
+    }
+    storeLevels(&p);
+}
+
+/* 32-bit: one word per sample. */
+static void convertFrames32(const uint8 *src, uint16 dst, uint16 n) {
+    const uint32 *w = (const uint32 *)src;
+    FRAME_PTR p;
+    uint32 l;
+    uint32 r;
+
+    initFramePtr(&p, dst);
+
+    while (n-- > 0u) {
+        l = *w++;
+        r = *w++;
+        storeFrame(&p, l, r);
+    }
+    storeLevels(&p);
+}
+#endif
+
+/*******************************************************************************
+*  Select the conversion kernel for the active alternate setting. Unknown
+*  settings, and 24/32-bit without AUDIO_WIDE_FORMATS, fall back to 16-bit.
+*******************************************************************************/
+void setAudioFormat(uint8 altSetting) {
+    uint8 intr = CyEnterCriticalSection();
+
+    switch (altSetting) {
+#if (AUDIO_WIDE_FORMATS)
+    case ALT_SETTING_24BIT:
+        convertFrames = &convertFrames24;
+        frameBytes = AUDIO_CH*3u;
+        break;
+    case ALT_SETTING_32BIT:
+        convertFrames = &convertFrames32;
+        frameBytes = AUDIO_CH*4u;
+        break;
+#endif
+    default:
+        convertFrames = &convertFrames16;
+        frameBytes = AUDIO_CH*2u;
+        break;
+    }
+
+    CyExitCriticalSection(intr);
+}
+
+#if (AUDIO_CONCEAL)
+/*******************************************************************************
+*  Read the frame at index idx of the sound buffers as left-aligned 32-bit
+*  samples, from the I2S frame when there is one.
+*******************************************************************************/
+static void loadFrame(uint16 idx, uint32 *l, uint32 *r) {
+#if (USE_I2S_OUTPUT)
+    const uint8 *i2s = &soundBuffer_I2S[idx*I2S_DATA_SIZE];
+#if (I2S_DATA_BITS == 16)
+    uint32 w = REV16(*(const uint32 *)i2s);
+
+    *l = w << 16;
+    *r = w & 0xFFFF0000u;
+#elif (I2S_DATA_BITS == 24)
+    *l = ((uint32)i2s[0] << 24) | ((uint32)i2s[1] << 16) | ((uint32)i2s[2] << 8);
+    *r = ((uint32)i2s[3] << 24) | ((uint32)i2s[4] << 16) | ((uint32)i2s[5] << 8);
+#else
+    *l = REV32(((const uint32 *)i2s)[0]);
+    *r = REV32(((const uint32 *)i2s)[1]);
+#endif
+#else
+    *l = (uint32)(soundBuffer_L[idx] ^ 0x80u) << 24;
+    *r = (uint32)(soundBuffer_R[idx] ^ 0x80u) << 24;
+#endif
+}
+
+/*******************************************************************************
+*  Overwrite the frame at index idx of the sound buffers with l and r scaled
+*  by gain/AUDIO_FADE_FRAMES. The VDAC bytes are truncated.
+*******************************************************************************/
+static void storeFadedFrame(uint16 idx, uint32 l, uint32 r, uint16 gain) {
+    l = (uint32)(((int32)l >> AUDIO_FADE_LOG2) * gain);
+    r = (uint32)(((int32)r >> AUDIO_FADE_LOG2) * gain);
+
+#if (USE_I2S_OUTPUT)
+    (void)storeI2SFrame(&soundBuffer_I2S[idx*I2S_DATA_SIZE], l, r);
+#endif
+#if (USE_VDAC_OUTPUT)
+    soundBuffer_L[idx] = (uint8)(l >> 24) ^ 0x80u;
+    soundBuffer_R[idx] = (uint8)(r >> 24) ^ 0x80u;
+#endif
+}
+
+/*******************************************************************************
+*  Conceal n frames from index dst, which must not cross a chunk: l and r
+*  faded out over the fade frames left, then silence. Returns the fade frames
+*  left after them.
+*******************************************************************************/
+static uint16 concealFrames(uint16 dst, uint16 n, uint32 l, uint32 r, uint16 fade) {
+    uint16 k = (n < fade) ? n : fade;
+    uint16 i;
+
+    for (i = 0u; i < k; i++) {
+        storeFadedFrame(dst + i, l, r, fade - 1u - i);
+    }
+    dst += k;
+    n -= k;
+
+#if (USE_I2S_OUTPUT)
+    (void)memset(&soundBuffer_I2S[dst*I2S_DATA_SIZE], 0, n*I2S_DATA_SIZE);
+#endif
+#if (USE_VDAC_OUTPUT)
+    (void)memset(&soundBuffer_L[dst], 0x80, n);
+    (void)memset(&soundBuffer_R[dst], 0x80, n);
+#endif
+
+    return fade - k;
+}
+
+/*******************************************************************************
+*  Conceal an under-run from VdacDmaDone, fill frames ahead of the DMAs. The
+*  chunk the DMAs have started is left alone: the rest of the chunk after it
+*  fades out from the last frame filled, or goes on with the fade-out of the
+*  chunks already concealed, and the receive stage resumes after it.
+*******************************************************************************/
+static void concealUnderrun(uint16 fill) {
+    uint16 mask = soundRing.mask;
+    uint16 next = (ringTailIndex(&soundRing) + transferSize) & mask;
+    uint16 n = (fill > transferSize) ? (uint16)(fill - transferSize) : 0u;
+
+    if (0u == concealing) {
+        loadFrame((ringTailIndex(&soundRing) + fill - 1u) & mask, &concealL, &concealR);
+        concealFade = AUDIO_FADE_FRAMES;
+        concealing = 1u;
+    }
+    concealFade = concealFrames(next + n, transferSize - n, concealL, concealR, concealFade);
+
+    concealEnd = (uint16)(soundRing.tail + 2u*transferSize);
+    concealSeq++;
+}
+
+/*******************************************************************************
+*  Let the receive stage resume after the frames concealed by VdacDmaDone.
+*  Called with VdacDmaDone held off.
+*******************************************************************************/
+static void resumeConceal(void) {
+    uint16 n = (uint16)(concealEnd - soundRing.head);
+
+    if ((int16)n > 0) {
+        ringPublish(&soundRing, n);
+    }
+    concealAck = concealSeq;
+}
+
+/*******************************************************************************
+*  End a concealment in progress without a fade-in, with the DMAs stopped.
+*  Called by setLatencyProfile() and when the audio interface is stopped, in
+*  a critical section.
+*******************************************************************************/
+void resetConceal(void) {
+    if (concealAck != concealSeq) {
+        resumeConceal();
+    }
+    concealing = 0u;
+    concealFade = 0u;
+    fadeInCount = AUDIO_FADE_FRAMES;
+}
+
+/*******************************************************************************
+*  Fade in n frames from ring position head, continuing the fade-in after a
+*  concealment.
+*******************************************************************************/
+static void fadeInFrames(uint16 head, uint16 n) {
+    uint32 l;
+    uint32 r;
+    uint16 idx;
+
+    while ((n-- > 0u) && (fadeInCount < AUDIO_FADE_FRAMES)) {
+        idx = head++ & soundRing.mask;
+        loadFrame(idx, &l, &r);
+        storeFadedFrame(idx, l, r, ++fadeInCount);
+    }
+}
+#endif
+
+/*******************************************************************************
+*  Separate 2-channel packet data in the format selected by setAudioFormat()
+*  and append it into the VDAC and I2S buffers. Returns 0 and drops the packet
+*  when there is no room for it. src must be 32-bit aligned.
+*******************************************************************************/
+uint8 writeAudioBuffers(const uint8 *src, uint16 size) {
+    uint16 frames = size/frameBytes;
+    uint16 head;
+    uint16 n;
+    uint8 intr;
+
+#if (AUDIO_CONCEAL)
+    /* VdacDmaDone conceals from the head of the ring: hold it off until the
+     * packet is published, so that it never overwrites the frames written. */
+    VdacDmaDone_Disable();
+
+    /* Resume after the frames concealed by VdacDmaDone. */
+    if (concealAck != concealSeq) {
+        resumeConceal();
+        fadeInCount = 0u;
+    }
+#endif
+
+    /* Check if there is a room to receive data. */
+    if (frames > ringSpace(&soundRing)) {
+        intr = CyEnterCriticalSection();
+        flag|=USB_DROP_FLAG;
+        CyExitCriticalSection(intr);
+#if (AUDIO_CONCEAL)
+        VdacDmaDone_Enable();
+#endif
+        return 0u;
+    }
+
+    intr = CyEnterCriticalSection();
+    flag&=~USB_DROP_FLAG;
+    CyExitCriticalSection(intr);
+
+    /* Split the packet at the buffer end so that the loop never wraps. */
+    head = ringHeadIndex(&soundRing);
+    n = bufferSize - head;
+    n = (frames < n) ? frames : n;
+    convertFrames(src, head, n);
+    convertFrames(src + n*frameBytes, 0u, frames - n);
+#if (AUDIO_CONCEAL)
+    if (fadeInCount < AUDIO_FADE_FRAMES) {
+        fadeInFrames(soundRing.head, frames);
+    }
+#endif
+    ringPublish(&soundRing, frames);
+#if (AUDIO_CONCEAL)
+    VdacDmaDone_Enable();
+#endif
+#if (AUDIO_LEVEL_METER)
+    levelFrames += frames;
+#endif
+
+    return 1u;
+}
+
+#if (AUDIO_LEVEL_METER)
+/*******************************************************************************
+*  Integer square root, rounded down.
+*******************************************************************************/
+static uint16 isqrt32(uint32 x) {
+    uint32 root = 0u;
+    uint32 bit = 1uL << 30;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (0u != bit) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint16)root;
+}
+
+/*******************************************************************************
+*  Read the levels of the frames received since the previous call and restart
+*  them. Called from the main loop.
+*******************************************************************************/
+void getLevels(AUDIO_LEVELS *lv) {
+    uint64 sumSq[AUDIO_CH];
+    uint32 frames;
+    uint8 intr;
+    uint8 ch;
+
+    intr = CyEnterCriticalSection();
+    frames = levelFrames;
+    for (ch = 0u; ch < AUDIO_CH; ch++) {
+        lv->peak[ch] = levelPeak[ch];
+        sumSq[ch] = levelSumSq[ch];
+        levelPeak[ch] = 0u;
+        levelSumSq[ch] = 0u;
+    }
+    levelFrames = 0u;
+    CyExitCriticalSection(intr);
+
+    for (ch = 0u; ch < AUDIO_CH; ch++) {
+        lv->rms[ch] = (0u == frames) ? 0u : isqrt32((uint32)(sumSq[ch]/frames));
+    }
+}
+#endif
+
+/*******************************************************************************
+*  Append a received packet into the audio buffers and publish the receive
+*  stage status. rxOutIndexVDAC/I2S must already hold the DMA transfer points
+*  sampled when the packet was taken.
+*******************************************************************************/
+static void storeOutPacket(const uint8 *packet, uint16 size) {
+    PROFILE_BEGIN(PROFILE_CONVERT);
+    if (0u == writeAudioBuffers(packet, size)) {
+        rxDropCount++;
+    }
+    PROFILE_END(PROFILE_CONVERT);
+
+    rxDist0 = ringFill(&soundRing);
+    rxDist = ringAhead(&soundRing, rxOutIndexI2S);
+    rxPacketCount++;
+}
+
+/*******************************************************************************
+*  Receive stage: take a received packet from the OUT endpoint and append it
+*  into the audio buffers. Called by the main loop when the OUT endpoint is full.
+*******************************************************************************/
+void receiveOutPacket() {
+    DMA_POSITION pos;
+    const uint8 *packet;
+    uint16 size;
+
+    /* Get current output index of DMA. */
+    getOutIndex(&pos);
+    rxOutIndexVDAC = pos.vdacL;
+    rxOutIndexI2S = pos.i2s;
+
+    PROFILE_BEGIN(PROFILE_EP_READ);
+    packet = readOutPacket(&size);
+    PROFILE_END(PROFILE_EP_READ);
+    storeOutPacket(packet, size);
+#if (USBFS_EP_MANAGEMENT_DMA_AUTO)
+    /* rawPacket is free again. */
+    enableOutPacket();
+#endif
+}
+
+#if (AUDIO_ASYNC_MODE)
+/*******************************************************************************
+*  Load a feedback value [10.14 samples/frame] into the feedback endpoint if it
+*  has been sent (or never been loaded) while audio is streaming.
+*******************************************************************************/
+void loadFeedback(uint32 feedback) {
+    if ((0u != USBFS_GetInterfaceSetting(AUDIO_INTERFACE)) &&
+        (USBFS_IN_BUFFER_EMPTY == USBFS_GetEPState(FB_EP_NUM))) {
+        fbBuf[0] = LO8(feedback);
+        fbBuf[1] = HI8(feedback);
+        fbBuf[2] = LO8(feedback >> 16);
+        USBFS_LoadInEP(FB_EP_NUM, fbBuf, FB_SIZE);
+    }
+}
+#endif
+
+#if (AUDIO_OUT_ISR_MODE)
+#if (USBFS_EP_MANAGEMENT_DMA_AUTO)
+/*******************************************************************************
+*  OUT endpoint ISR exit callback. The endpoint DMA has already written the
+*  packet, so the whole receive stage runs here.
+*******************************************************************************/
+void USBFS_EP_2_ISR_ExitCallback() {
+    receiveOutPacket();
+}
+
+void USBFS_ARB_ISR_ExitCallback() {
+}
+#else
+/* Size of the packet being copied into tmpEpBuf, 0 when idle. */
+static volatile uint16 rxSize = 0u;
+
+/*******************************************************************************
+*  OUT endpoint ISR exit callback. Starts copying the packet into tmpEpBuf.
+*  The copy completion is reported through the arbiter ISR.
+*******************************************************************************/
+void USBFS_EP_2_ISR_ExitCallback() {
+    DMA_POSITION pos;
+    PROFILE_BEGIN(PROFILE_EP_READ);
+
+    /* Get current output index of DMA. */
+    getOutIndex(&pos);
+    rxOutIndexVDAC = pos.vdacL;
+    rxOutIndexI2S = pos.i2s;
+
+    /* Trigger DMA to copy data from OUT endpoint buffer. */
+    rxSize = USBFS_GetEPCount(OUT_EP_NUM);
+    USBFS_ReadOutEP(OUT_EP_NUM, tmpEpBuf, rxSize);
+    PROFILE_END(PROFILE_EP_READ);
+}
+
+/*******************************************************************************
+*  Arbiter ISR exit callback. Once the copy started by the OUT endpoint ISR has
+*  completed, re-arm the endpoint and append the packet into the audio buffers.
+*******************************************************************************/
+void USBFS_ARB_ISR_ExitCallback() {
+    uint16 size = rxSize;
+
+    if ((0u != size) && (USBFS_OUT_BUFFER_FULL != USBFS_GetEPState(OUT_EP_NUM))) {
+        rxSize = 0u;
+        enableOutPacket();
+        storeOutPacket(tmpEpBuf, size);
+    }
+}
+#endif
+#endif
+
+/*******************************************************************************
+*  The Interrupt Service Routine for a DMA transfer completion event. When
+*  there is no data to send, the DMA is stopped, or the under-run concealed
+*  in the profiles that conceal.
+*******************************************************************************/
+CY_ISR(VdacDmaDone) {
+    PROFILE_BEGIN(PROFILE_VDAC_ISR);
+
+    /* Release the chunk sent. */
+    ringRelease(&soundRing, transferSize);
+#if (AUDIO_CONCEAL)
+    /* Conceal the chunk after the one started unless it is filled. The fill
+     * level only counts once the receive stage has resumed after the last
+     * concealment. */
+    if (0u != concealOn) {
+        if (concealAck != concealSeq) {
+            concealUnderrun(transferSize);
+            flag |= CONCEAL_FLAG;
+        } else if (ringFill(&soundRing) < 2u*transferSize) {
+            concealUnderrun(ringFill(&soundRing));
+            flag |= CONCEAL_FLAG;
+        } else {
+            concealing = 0u;
+        }
+    } else if (ringFill(&soundRing) < transferSize) {
+        flag |= DMA_STOP_FLAG;
+    }
+#else
+    /* Stop unless the chunk started is filled. */
+    if (ringFill(&soundRing) < transferSize) {
+        flag |= DMA_STOP_FLAG;
+    }
+#endif
+
+    PROFILE_END(PROFILE_VDAC_ISR);
+}
+
+/* [] END OF FILE */
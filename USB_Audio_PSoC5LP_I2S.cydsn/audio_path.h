@@ -0,0 +1,312 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Audio data path: USB OUT endpoint -> circular sound buffers -> VDAC/I2S DMA.
+*
+* Only readOutPacket(), initDMAs(), setLatencyProfile(), getOutIndex() and
+* the DMA completion ISR touch the hardware. Packet extraction and the buffer index
+* arithmetic use nothing but cytypes, so this file and audio_path.c can be
+* compiled on a host against mock USBFS/DMA/VDAC/I2S headers (host/mock).
+*
+* The build switches below can be given on the compiler command line, which
+* the host build uses to check each variant.
+*
+*******************************************************************************/
+#if !defined(AUDIO_PATH_H)
+#define AUDIO_PATH_H
+
+#include <project.h>
+#include "cyapicallbacks.h"
+#include "audio_ring.h"
+
+/*
+ * USB synchronization type of the audio stream.
+ *  0: Adaptive. The BitClk follows the host by steering FracDiv.
+ *  1: Asynchronous. The BitClk runs at the nominal divider and the host is told
+ *     the actual rate through the explicit feedback endpoint FB_EP_NUM.
+ * Asynchronous mode needs the USBFS descriptors changed in TopDesign: the OUT
+ * endpoint as isochronous asynchronous (bmAttributes 0x05, bSynchAddress 0x83)
+ * and an isochronous feedback IN endpoint 3 (bmAttributes 0x11, 3 bytes,
+ * bRefresh 1) in the same alternate setting, and wMaxPacketSize of the OUT
+ * endpoint raised to USB_BUF_SIZE.
+ */
+#if !defined(AUDIO_ASYNC_MODE)
+#define AUDIO_ASYNC_MODE    (0u)
+#endif
+#define FB_EP_NUM           (3u)
+#define FB_SIZE             (3u)
+
+/* UBSFS device constants. */
+#define USBFS_AUDIO_DEVICE  (0u)
+#define AUDIO_INTERFACE     (1u)
+#define OUT_EP_NUM          (2u)
+#define AUDIO_CH            (2u)
+#define MAX_BYTES_PER_CH    (4u)
+
+/*
+ * Sample formats of the audio streaming interface.
+ *  0: 16-bit only. Alternate settings 2 and 3 fall back to 16-bit, and the
+ *     packet buffers (rawPacket, tmpEpBuf) hold 16-bit packets only.
+ *  1: 24-bit and 32-bit as well, on alternate settings 2 and 3. Needs their
+ *     format descriptors in TopDesign, see below. The packet buffers grow to a
+ *     96kHz 32-bit packet, 768 bytes each. host/tests/test_kernels compares
+ *     the per-frame cost of the three kernels.
+ */
+#if !defined(AUDIO_WIDE_FORMATS)
+#define AUDIO_WIDE_FORMATS  (0u)
+#endif
+
+/*
+ * Sampling rates of 16-bit streams.
+ *  0: Up to 96kHz, as in the default TopDesign descriptors.
+ *  1: Up to 192kHz. Needs 176.4/192kHz in the 16-bit sampling frequency list,
+ *     wMaxPacketSize 768 and the USBFS component set to DMA with automatic
+ *     memory management in TopDesign. The DMA chunks double to hold 10.7ms at
+ *     192kHz, which takes the sound buffers from 6KB to 12KB with 16-bit I2S.
+ */
+#if !defined(AUDIO_HIGH_RATES)
+#define AUDIO_HIGH_RATES    (0u)
+#endif
+
+/*
+ * Largest packets [frames]. 16-bit streams go up to 192kHz with
+ * AUDIO_HIGH_RATES, 96kHz otherwise, and 24/32-bit streams up to 96kHz, which
+ * keeps every packet within the 1023 bytes of a full speed isochronous
+ * endpoint. Packets over 512 bytes need the USBFS component set to DMA with
+ * automatic memory management. Asynchronous mode adds one frame for feedback
+ * corrections.
+ */
+#if (AUDIO_HIGH_RATES)
+#define MAX_FRAMES_16BIT    (192u + AUDIO_ASYNC_MODE)
+#else
+#define MAX_FRAMES_16BIT    (96u + AUDIO_ASYNC_MODE)
+#endif
+#define MAX_FRAMES_32BIT    (96u + AUDIO_ASYNC_MODE)
+#if (AUDIO_WIDE_FORMATS)
+#define USB_BUF_SIZE        ((MAX_FRAMES_16BIT*2u > MAX_FRAMES_32BIT*MAX_BYTES_PER_CH) ? \
+                             (MAX_FRAMES_16BIT*AUDIO_CH*2u) : (MAX_FRAMES_32BIT*AUDIO_CH*MAX_BYTES_PER_CH))
+#else
+#define USB_BUF_SIZE        (MAX_FRAMES_16BIT*AUDIO_CH*2u)
+#endif
+
+/*
+ * Alternate settings of the audio streaming interface, 2 and 3 with
+ * AUDIO_WIDE_FORMATS only. Each one needs its own Type I format descriptor in
+ * TopDesign (bSubslotSize/bBitResolution 2/16, 3/24 and 4/32) with
+ * wMaxPacketSize for its largest packet.
+ */
+#define ALT_SETTING_16BIT   (1u)
+#define ALT_SETTING_24BIT   (2u)
+#define ALT_SETTING_32BIT   (3u)
+
+/*
+ * Outputs fed from the sound buffers. Each enabled output keeps its own ring,
+ * as the DMA cannot pick the VDAC bytes (offset binary) out of the I2S frames
+ * (two's complement, MSB first). A single output saves the other ring and its
+ * per-sample stores.
+ *  AUDIO_OUTPUT_BOTH: VDAC and I2S, 6 bytes per frame with 16-bit I2S.
+ *  AUDIO_OUTPUT_I2S:  I2S only, 4 bytes per frame. VdacDma_L keeps running
+ *                     from a fixed mid-scale byte to pace VdacDmaDone.
+ *  AUDIO_OUTPUT_VDAC: VDAC only, 2 bytes per frame.
+ */
+#define AUDIO_OUTPUT_VDAC   (1u)
+#define AUDIO_OUTPUT_I2S    (2u)
+#define AUDIO_OUTPUT_BOTH   (AUDIO_OUTPUT_VDAC | AUDIO_OUTPUT_I2S)
+#if !defined(AUDIO_OUTPUT)
+#define AUDIO_OUTPUT        (AUDIO_OUTPUT_BOTH)
+#endif
+#define USE_VDAC_OUTPUT     (0u != (AUDIO_OUTPUT & AUDIO_OUTPUT_VDAC))
+#define USE_I2S_OUTPUT      (0u != (AUDIO_OUTPUT & AUDIO_OUTPUT_I2S))
+
+/*
+ * Requantization of the 8-bit VDAC samples.
+ *  0: Truncation to the upper sample byte.
+ *  1: TPDF dither and error feedback noise shaping at 88.2kHz and above,
+ *     truncation below, where dither alone loses SNR. setVdacShaper()
+ *     selects the shaper for the sampling rate. By instruction count the
+ *     shaper takes about 20 cycles per VDAC sample on the Cortex-M3 (three
+ *     multiplies, the LCG step, clamps), 3.8M cycles/s at 96kHz; an
+ *     estimate, not yet measured on the target.
+ */
+#if !defined(VDAC_NOISE_SHAPING)
+#define VDAC_NOISE_SHAPING  (0u)
+#endif
+
+/*
+ * Level metering.
+ *  0: None.
+ *  1: The conversion kernels keep the peak magnitude and the sum of squares of
+ *     each channel's top 16 bits in the same pass as the sound buffer writes.
+ *     getLevels() reads and restarts them. By instruction count this is about
+ *     7 cycles per sample on the Cortex-M3 (ASR, abs, compare/select, MUL,
+ *     64-bit add), 1.4k cycles per ms at 96kHz; not yet measured, compare
+ *     PROFILE_CONVERT with and without it before turning it on. level_meter.c
+ *     needs the CharLCD custom character set set to the horizontal bar graph.
+ */
+#if !defined(AUDIO_LEVEL_METER)
+#define AUDIO_LEVEL_METER   (0u)
+#endif
+
+/*
+ * Buffer under-run handling.
+ *  0: VdacDmaDone sets DMA_STOP_FLAG and the main loop stops the BitClk until
+ *     the ring is filled up to the servo start level again.
+ *  1: Concealment, but for LATENCY_PROFILE_LOW, whose ring is too short to
+ *     look a chunk ahead. The clocks keep running and the servo keeps its
+ *     state. When the chunk after the one it starts is not filled,
+ *     VdacDmaDone fades the frames missing from it out from the last frame
+ *     received over AUDIO_FADE_FRAMES frames, silencing the rest, and the
+ *     receive stage resumes after it with a fade-in over AUDIO_FADE_FRAMES
+ *     frames. The chunk the DMAs have started is never written, nor the
+ *     packet being received: the receive stage holds VdacDmaDone off while
+ *     it writes. The servo rebuilds the rest of the fill level.
+ */
+#if !defined(AUDIO_CONCEAL)
+#define AUDIO_CONCEAL       (1u)
+#endif
+#define AUDIO_FADE_LOG2     (6u)
+#define AUDIO_FADE_FRAMES   (1u << AUDIO_FADE_LOG2)
+
+/* Audio buffer constants. The ring and the DMA chunks are powers of two, so
+ * ring positions are masked rather than divided, and a chunk needs not hold a
+ * whole packet. These size the buffers, the active ring region is set by the
+ * latency profile. A TD moves at most 4095 bytes. */
+#if (AUDIO_HIGH_RATES)
+#define TRANSFER_SIZE_LOG2  (8u)
+#else
+#define TRANSFER_SIZE_LOG2  (7u)
+#endif
+#define TRANSFER_SIZE       (1u << TRANSFER_SIZE_LOG2)
+#define NUM_OF_BUFFERS      (8u)
+#define BUFFER_SIZE         (TRANSFER_SIZE * NUM_OF_BUFFERS)
+#define sHALF_BUFFER_SIZE   ((int16)(bufferSize/2u))
+
+#define I2S_CLOCK_FACTOR    (I2S_DATA_BITS*AUDIO_CH*2)
+#define I2S_DATA_SIZE       (I2S_DATA_BITS/8*AUDIO_CH)
+#define I2S_TRANSFER_SIZE   (TRANSFER_SIZE*I2S_DATA_SIZE)
+#define I2S_BUFFER_SIZE     (I2S_TRANSFER_SIZE * NUM_OF_BUFFERS)
+
+#if (I2S_TRANSFER_SIZE > 4095u)
+#error "An I2S DMA chunk exceeds the TD transfer count."
+#endif
+
+/*
+ * Latency profiles, selected at runtime by setLatencyProfile(). A profile sets
+ * the number of DMA chunks in the active ring region, a power of two, and the
+ * chunk size in largest USB packets of the sampling rate, rounded up to a
+ * power of two and limited to TRANSFER_SIZE frames. The DMAs start at half of
+ * the ring, which gives the buffering delay noted.
+ *  LATENCY_PROFILE_DEEP:   NUM_OF_BUFFERS chunks of 2 packets (10.7ms,
+ *                          11.6ms at 44.1kHz, 5.3ms at 96kHz without
+ *                          AUDIO_HIGH_RATES, 5.3ms at 192kHz). The default.
+ *  LATENCY_PROFILE_MEDIUM: 8 chunks of 1 packet (5.3ms, 5.8ms at 44.1kHz).
+ *  LATENCY_PROFILE_LOW:    4 chunks of 1 packet (2.7ms, 2.9ms at 44.1kHz).
+ */
+#define LATENCY_PROFILE_DEEP    (0u)
+#define LATENCY_PROFILE_MEDIUM  (1u)
+#define LATENCY_PROFILE_LOW     (2u)
+#define LATENCY_PROFILES        (3u)
+
+/* Received USB packet buffer. The USBFS component in TopDesign uses DMA with
+ * manual memory management, so the default build copies each packet into
+ * tmpEpBuf and waits for the copy. The zero-copy receive only takes effect
+ * when the component is switched to DMA with automatic memory management:
+ * the endpoint DMA then writes packets directly into rawPacket, which takes
+ * the place of tmpEpBuf at the same size. The endpoint is re-armed once the
+ * packet has been converted, well before the next one is due 1ms later. */
+#if (USBFS_EP_MANAGEMENT_DMA_AUTO)
+extern uint8 rawPacket[USB_BUF_SIZE];
+#else
+extern uint8 tmpEpBuf[USB_BUF_SIZE];
+#endif
+
+/* Circular buffer for audio stream. */
+#if (USE_VDAC_OUTPUT)
+extern uint8 soundBuffer_L[BUFFER_SIZE];
+extern uint8 soundBuffer_R[BUFFER_SIZE];
+#endif
+#if (USE_I2S_OUTPUT)
+extern uint8 soundBuffer_I2S[I2S_BUFFER_SIZE];
+#endif
+
+/* Active ring region set by the latency profile: numOfBuffers chunks of
+ * transferSize frames, bufferSize frames in total. soundRing counts the frames
+ * written by the receive stage and released by VdacDmaDone, a chunk at a time,
+ * so its fill level includes the chunk the DMAs are sending. */
+extern AUDIO_RING soundRing;
+extern uint8 numOfBuffers;
+extern uint16 transferSize;
+extern uint8 transferSizeLog2;
+extern uint16 bufferSize;
+
+/* DMA transfer points [frames], sampled together by getOutIndex(). Outputs
+ * that are not enabled report the transfer point of the one that is. */
+typedef struct {
+    uint16 vdacL;
+    uint16 vdacR;
+    uint16 i2s;
+} DMA_POSITION;
+
+#if (AUDIO_LEVEL_METER)
+/* Levels since the previous getLevels() call, 32768 = full scale. */
+typedef struct {
+    uint16 peak[AUDIO_CH];
+    uint16 rms[AUDIO_CH];
+} AUDIO_LEVELS;
+#endif
+
+/*
+ * Operation Flag.
+ *  bit 0 => Buffer under-run concealed.
+ *  bit 1 => DMA for VDAC is stopped due to buffer under-run.
+ *  bit 2 => USB packet is dropped due to buffer over-run.
+ */
+extern volatile uint8 flag;
+#define CONCEAL_FLAG             (1u<<0)
+#define DMA_STOP_FLAG            (1u<<1)
+#define USB_DROP_FLAG            (1u<<2)
+
+/*
+ * Receive stage status, updated for every packet taken from the OUT endpoint.
+ * The stage runs from the main loop, or from the USBFS ISRs when
+ * AUDIO_OUT_ISR_MODE is set in cyapicallbacks.h.
+ *  rxPacketCount   => received packets (wraps).
+ *  rxDropCount     => packets dropped due to buffer over-run (wraps).
+ *  rxOutIndexVDAC  => VDAC DMA transfer point when the packet was taken.
+ *  rxOutIndexI2S   => I2S DMA transfer point when the packet was taken.
+ *  rxDist          => buffered frames ahead of the I2S DMA after the packet.
+ *  rxDist0         => buffered frames ahead of the VDAC DMA chunk.
+ */
+extern volatile uint8 rxPacketCount;
+extern volatile uint8 rxDropCount;
+extern volatile uint16 rxOutIndexVDAC;
+extern volatile uint16 rxOutIndexI2S;
+extern volatile uint16 rxDist;
+extern volatile uint16 rxDist0;
+
+/* Function prototype deffinitions. */
+void initDMAs(void);
+void setLatencyProfile(uint8 profile, uint32 fs);
+void getOutIndex(DMA_POSITION *pos);
+void enableOutPacket(void);
+const uint8 *readOutPacket(uint16 *size);
+void setAudioFormat(uint8 altSetting);
+#if (VDAC_NOISE_SHAPING)
+void setVdacShaper(uint32 fs);
+#endif
+uint8 writeAudioBuffers(const uint8 *src, uint16 size);
+#if (AUDIO_CONCEAL)
+void resetConceal(void);
+#endif
+#if (AUDIO_LEVEL_METER)
+void getLevels(AUDIO_LEVELS *lv);
+#endif
+void receiveOutPacket(void);
+#if (AUDIO_ASYNC_MODE)
+void loadFeedback(uint32 feedback);
+#endif
+CY_ISR_PROTO(VdacDmaDone);
+
+#endif /* AUDIO_PATH_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,82 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Single-producer/single-consumer ring index for the sound buffers. The debug
+* log uses it for its byte ring too.
+*
+* The receive stage (main loop or USBFS ISR) is the only writer of head and
+* the DMA completion ISR the only writer of tail. Both are free running 16-bit
+* frame counts, each stored by a single halfword write, so either side reads
+* the other's count without a lock:
+*  - The fill level is head - tail modulo 2^16, exact in O(1) as long as the
+*    ring is a power of two of at most 2^15 frames.
+*  - The buffer position of a count is the count masked by the ring size.
+*  - A side sees the fill level of the moment it read the other count, which
+*    is at most what the producer has written and at least what the consumer
+*    has not yet released, i.e. the safe side for both.
+* A __DMB() orders each publish after the buffer accesses it covers.
+*
+*******************************************************************************/
+#if !defined(AUDIO_RING_H)
+#define AUDIO_RING_H
+
+#include <project.h>
+
+typedef struct {
+    volatile uint16 head;   /* Frames written by the producer. */
+    volatile uint16 tail;   /* Frames released by the consumer. */
+    uint16 mask;            /* Ring size - 1. */
+} AUDIO_RING;
+
+/*******************************************************************************
+*  Empty the ring and set its size, a power of two. Neither side may run.
+*******************************************************************************/
+static CY_INLINE void ringInit(AUDIO_RING *r, uint16 size) {
+    r->head = 0u;
+    r->tail = 0u;
+    r->mask = size - 1u;
+}
+
+/* Frames written and not yet released. */
+static CY_INLINE uint16 ringFill(const AUDIO_RING *r) {
+    return (uint16)(r->head - r->tail);
+}
+
+/* Frames the producer can write. */
+static CY_INLINE uint16 ringSpace(const AUDIO_RING *r) {
+    return (uint16)(r->mask + 1u - ringFill(r));
+}
+
+/* Buffer positions of the next frame to write and to release. */
+static CY_INLINE uint16 ringHeadIndex(const AUDIO_RING *r) {
+    return r->head & r->mask;
+}
+
+static CY_INLINE uint16 ringTailIndex(const AUDIO_RING *r) {
+    return r->tail & r->mask;
+}
+
+/* Frames written ahead of buffer position index. */
+static CY_INLINE uint16 ringAhead(const AUDIO_RING *r, uint16 index) {
+    return (uint16)(r->head - index) & r->mask;
+}
+
+/*******************************************************************************
+*  Producer: publish n frames written from ringHeadIndex().
+*******************************************************************************/
+static CY_INLINE void ringPublish(AUDIO_RING *r, uint16 n) {
+    __DMB();
+    r->head = (uint16)(r->head + n);
+}
+
+/*******************************************************************************
+*  Consumer: release n frames from ringTailIndex() to the producer.
+*******************************************************************************/
+static CY_INLINE void ringRelease(AUDIO_RING *r, uint16 n) {
+    __DMB();
+    r->tail = (uint16)(r->tail + n);
+}
+
+#endif /* AUDIO_RING_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,572 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* I2S BitClk generator (FracDiv) servo.
+*
+*******************************************************************************/
+#include "clock_servo.h"
+#include "profiler.h"
+
+#define ABS(x)                      (((x) < 0) ? -(x) : (x))
+#define SERVO_DIST(x)               ((int32)(x) * (int32)(1uL << SERVO_DIST_Q))
+
+/* Dead band of the buffered data size based precise adjustment. */
+#if (SERVO_ADAPTIVE_TARGET)
+#define SERVO_UPPER_RANGE(s)        (+servoDeadBand(s))
+#define SERVO_LOWER_RANGE(s)        (-servoDeadBand(s))
+#else
+#define SERVO_UPPER_RANGE(s)        UpperAdjustRange
+#define SERVO_LOWER_RANGE(s)        LowerAdjustRange
+#endif
+
+/* Variables for BitClk frequency counter. */
+static volatile uint8 bitClkRestart = 0u;
+static uint8 bitClkCountWait = 0u;
+static uint16 bitClkGateCount = 0u;
+static uint32 bitClkGateSum = 0u;
+
+/* Published gate results. bitClkSum[bitClkSeq & 1] is the latest one. */
+static volatile uint32 bitClkSum[2];
+static volatile uint32 bitClkSeq = 0u;
+
+/*******************************************************************************
+*  Compute div*err/freq*gain rounded to nearest, where err and freq are in the
+*  same fixed-point format and gain is Q(SERVO_GAIN_Q). This is the integer
+*  form of (initialDiv+divAdj)*(fs/bitClkFreq - 1.0)*gain.
+*******************************************************************************/
+static int64 divCorrection(int64 div, int64 err, uint32 freq, uint16 gain) {
+    int64 n = div * err;
+    int64 d = (int64)freq;
+
+    n = (n < 0) ? ((n - d/2) / d) : ((n + d/2) / d);
+    n *= gain;
+
+    return (n + (1 << (SERVO_GAIN_Q-1u))) >> SERVO_GAIN_Q;
+}
+
+#if (SERVO_ADAPTIVE_TARGET)
+/*******************************************************************************
+*  Integer square root.
+*******************************************************************************/
+static uint16 isqrt32(uint32 x) {
+    uint32 r = 0u;
+    uint32 b = 1uL << 30;
+
+    while (b > x) {
+        b >>= 2;
+    }
+    while (0u != b) {
+        if (x >= r + b) {
+            x -= r + b;
+            r = (r >> 1) + b;
+        } else {
+            r >>= 1;
+        }
+        b >>= 2;
+    }
+
+    return (uint16)r;
+}
+
+/* Largest packet for fs [frames]. */
+#define SERVO_PACKET(s)             ((int32)(((s)->fs + 999u)/1000u) + AUDIO_ASYNC_MODE)
+
+/*******************************************************************************
+*  Smallest buffered data size that keeps the jitter a margin above underrun,
+*  i.e. a whole DMA chunk still buffered just before the next packet arrives.
+*******************************************************************************/
+static int32 servoRequiredLevel(const CLOCK_SERVO *s) {
+    return (int32)transferSize + SERVO_PACKET(s) + s->jitter + 2*(int32)s->margin;
+}
+
+/*******************************************************************************
+*  Required level limited by the rise against overrun, i.e. room for the next
+*  packet, but not below half of the ring.
+*******************************************************************************/
+static uint16 servoTargetLevel(const CLOCK_SERVO *s) {
+    int32 target = servoRequiredLevel(s);
+    int32 ceiling = (int32)bufferSize - SERVO_PACKET(s) - s->rise - s->margin;
+
+    ceiling = (ceiling < sHALF_BUFFER_SIZE) ? sHALF_BUFFER_SIZE : ceiling;
+
+    return (uint16)((target > ceiling) ? ceiling : target);
+}
+
+/*******************************************************************************
+*  Dead band around the target. When the ring is too short for the jitter the
+*  target is limited, and the fixed mode dead band rides out the jitter better.
+*******************************************************************************/
+static int16 servoDeadBand(const CLOCK_SERVO *s) {
+    return ((int32)s->target < servoRequiredLevel(s)) ? UpperAdjustRange : (int16)s->margin;
+}
+
+/*******************************************************************************
+*  Forget the observed jitter. The target stays at half of the ring until a
+*  whole window has been observed.
+*******************************************************************************/
+static void servoResetJitter(CLOCK_SERVO *s) {
+    uint8 i;
+
+    for (i = 0u; i < SERVO_JITTER_BLOCKS; i++) {
+        s->windowDip[i] = 0xFFFFu;
+        s->windowRise[i] = 0xFFFFu;
+    }
+    s->blockIndex = 0u;
+    s->blockCount = 0u;
+    s->blockDip = 0u;
+    s->blockRise = 0u;
+    s->blockSumSq = 0u;
+    s->jitter = 0xFFFFu;
+    s->rise = 0xFFFFu;
+}
+#endif
+
+/*******************************************************************************
+*  Nominal FracDiv value for fs.
+*******************************************************************************/
+static uint32 servoNominalDiv(uint32 fs) {
+    return (uint32)(((uint64)fs * I2S_CLOCK_FACTOR * div_MAX) / DIVIDER_SOURCE_FREQ);
+}
+
+/*******************************************************************************
+*  Divider offset to start fs from: the one learned for fs, else the trim.
+*******************************************************************************/
+static int32 servoSeedAdj(CLOCK_SERVO *s) {
+    uint8 i;
+
+    s->rate = SERVO_RATE_NONE;
+    for (i = 0u; i < SERVO_RATES; i++) {
+        if (s->fs == s->rates[i].fs) {
+            s->rate = i;
+            return s->rates[i].divAdj;
+        }
+    }
+
+    return (int32)((int64)s->trim * s->initialDiv / SERVO_TRIM_SCALE);
+}
+
+/*******************************************************************************
+*  Keep the divider offset for fs, taking an unused entry or the oldest one for
+*  a new rate, and update the trim.
+*******************************************************************************/
+static void servoLearnAdj(CLOCK_SERVO *s) {
+    uint8 i;
+
+    if (SERVO_RATE_NONE == s->rate) {
+        for (i = 0u; (i < SERVO_RATES) && (0u != s->rates[i].fs); i++) {
+        }
+        if (SERVO_RATES == i) {
+            i = s->nextRate;
+            s->nextRate = (i + 1u < SERVO_RATES) ? i + 1u : 0u;
+        }
+        s->rate = i;
+        s->rates[i].fs = s->fs;
+    }
+    s->rates[s->rate].divAdj = s->divAdj;
+    s->trim = (int32)((int64)s->divAdj * SERVO_TRIM_SCALE / s->initialDiv);
+}
+
+#if (SERVO_PI_CONTROL)
+/*******************************************************************************
+*  Scale the PI gains to divider LSBs at fs: a relative BitClk change u per
+*  frame of error makes the loop s^2 + fs*kp*s + fs*ki, so kp = 2*zeta*wn/fs
+*  and ki = wn^2/fs per second, times initialDiv.
+*******************************************************************************/
+static void servoSetGains(CLOCK_SERVO *s) {
+    uint64 wn = (uint64)6283185u * SERVO_PI_BANDWIDTH_MHZ / 1000u;    /* [urad/s] */
+    uint64 d = (uint64)1000u * s->fs;
+
+    if (0u == s->fs) {
+        s->kp = 0;
+        s->ki = 0;
+        return;
+    }
+    s->kp = (int32)((((uint64)s->initialDiv * (2u*SERVO_PI_DAMPING) * wn / 1000000u) << SERVO_PI_GAIN_Q) / d);
+    s->ki = (int32)(((((uint64)s->initialDiv * wn / 1000000u) * wn * SERVO_PI_PERIOD_MS / 1000000u)
+                     << SERVO_PI_GAIN_Q) / d);
+}
+#endif
+
+/*******************************************************************************
+*  Count fresh measurements within SERVO_LOCK_PPM in a row.
+*******************************************************************************/
+static void servoTrackLock(CLOCK_SERVO *s, int64 err) {
+    if (ABS(err)*(1000000/SERVO_LOCK_PPM) > ((int64)s->fs << SERVO_FREQ_Q)) {
+        s->locked = 0u;
+    } else if (s->locked < SERVO_LOCK_COUNT) {
+        s->locked++;
+    }
+}
+
+/*******************************************************************************
+*  Set new sampling rate and seed the divider with the offset learned for it.
+*******************************************************************************/
+void servoSetRate(CLOCK_SERVO *s, uint32 fs) {
+    s->fs = fs;
+    s->initialDiv = servoNominalDiv(fs);
+    s->divAdj = servoSeedAdj(s);
+    s->div = (uint32)((int64)s->initialDiv + s->divAdj);
+    s->weight = (uint32)(((uint64)fs << SERVO_WEIGHT_Q) / 10000000u);
+    s->feedback = (uint32)(((uint64)fs << SERVO_FB_Q) / 1000u);
+    s->clockAdjust = 0;
+    s->band = SERVO_BAND_NONE;
+    s->locked = 0u;
+#if (SERVO_PI_CONTROL)
+    servoSetGains(s);
+    s->integrator = (int64)s->divAdj << SERVO_PI_INT_Q;
+#endif
+#if (SERVO_ADAPTIVE_TARGET)
+    s->margin = (uint16)(((uint64)fs * SERVO_TARGET_MARGIN_US) / 1000000u);
+    s->fall = (uint16)(((uint64)fs * SERVO_TARGET_FALL_PPM << SERVO_JITTER_BLOCK_LOG2) / 1000000000u);
+    s->fall = (0u == s->fall) ? 1u : s->fall;
+    servoResetJitter(s);
+#endif
+    s->target = servoStartLevel(s);
+}
+
+/*******************************************************************************
+*  Restart the moving average of buffered data size.
+*******************************************************************************/
+void servoResetAverage(CLOCK_SERVO *s, uint16 dist) {
+    s->distAverage = (uint32)dist << SERVO_DIST_Q;
+    s->target = servoStartLevel(s);
+#if (SERVO_ADAPTIVE_TARGET)
+    s->lastDist = dist;
+#endif
+}
+
+/*******************************************************************************
+*  Feed one buffered data size sample into the moving average.
+*******************************************************************************/
+void servoUpdateAverage(CLOCK_SERVO *s, uint16 dist) {
+    int32 diff = (int32)((uint32)dist << SERVO_DIST_Q) - (int32)s->distAverage;
+
+    s->distAverage += (int32)(((int64)diff * s->weight) >> SERVO_WEIGHT_Q);
+}
+
+/*******************************************************************************
+*  Buffered data size at which the DMAs are started, i.e. the current target
+*  for the active ring.
+*******************************************************************************/
+uint16 servoStartLevel(const CLOCK_SERVO *s) {
+#if (SERVO_ADAPTIVE_TARGET)
+    return servoTargetLevel(s);
+#else
+    (void)s;
+    return sHALF_BUFFER_SIZE;
+#endif
+}
+
+#if (SERVO_ADAPTIVE_TARGET)
+/*******************************************************************************
+*  Feed one buffered data size sample into the jitter window while the DMAs
+*  are running, and move the target accordingly. Call after
+*  servoUpdateAverage().
+*******************************************************************************/
+void servoTrackJitter(CLOCK_SERVO *s, uint16 dist) {
+    int32 diff = (int32)dist - (int32)s->lastDist;
+    int32 dev = (int32)dist - (int32)((s->distAverage + (1uL << (SERVO_DIST_Q-1u))) >> SERVO_DIST_Q);
+    uint16 sigma;
+    uint16 level;
+    uint8 i;
+
+    s->lastDist = dist;
+    s->blockSumSq += (uint32)(diff * diff);
+
+    /* Deviation from the moving average, which follows the slow drift. */
+    if (dev < -(int32)s->blockDip) {
+        s->blockDip = (uint16)-dev;
+    }
+    if (dev > (int32)s->blockRise) {
+        s->blockRise = (uint16)dev;
+    }
+
+    /* A dip deeper than the window has seen raises the target at once. */
+    if (s->blockDip > s->jitter) {
+        s->jitter = s->blockDip;
+        level = servoTargetLevel(s);
+        s->target = (level > s->target) ? level : s->target;
+    }
+
+    if (++s->blockCount >= (1u << SERVO_JITTER_BLOCK_LOG2)) {
+        /* The change of independent samples has twice their variance. */
+        sigma = isqrt32(s->blockSumSq >> (SERVO_JITTER_BLOCK_LOG2 + 1u)) * SERVO_JITTER_SIGMAS;
+        s->windowDip[s->blockIndex] = (sigma > s->blockDip) ? sigma : s->blockDip;
+        s->windowRise[s->blockIndex] = (sigma > s->blockRise) ? sigma : s->blockRise;
+        s->blockIndex = (s->blockIndex + 1u) % SERVO_JITTER_BLOCKS;
+
+        s->jitter = 0u;
+        s->rise = 0u;
+        for (i = 0u; i < SERVO_JITTER_BLOCKS; i++) {
+            s->jitter = (s->windowDip[i] > s->jitter) ? s->windowDip[i] : s->jitter;
+            s->rise = (s->windowRise[i] > s->rise) ? s->windowRise[i] : s->rise;
+        }
+
+        /* Fall slowly so that the servo can follow without overshoot. */
+        level = servoTargetLevel(s);
+        if (level + s->fall < s->target) {
+            level = s->target - s->fall;
+        }
+        s->target = level;
+
+        s->blockCount = 0u;
+        s->blockDip = 0u;
+        s->blockRise = 0u;
+        s->blockSumSq = 0u;
+    }
+}
+#endif
+
+/*******************************************************************************
+*  BitClk adjustment. bitClkFreq is the measured BitClk based sampling rate in
+*  Q24.8 Hz. The frequency error is only corrected when fresh is set, i.e. the
+*  measurement has not been used yet, but it still selects the adjustment band.
+*  Returns 1 when s->div is changed and has to be written to FracDiv.
+*******************************************************************************/
+uint8 servoAdjust(CLOCK_SERVO *s, uint32 bitClkFreq, uint8 fresh) {
+    int64 total;
+    int64 err;
+    int64 tmpDiv;
+    int32 avgErr;
+    int32 tic;
+    uint8 gain;
+
+    s->band = SERVO_BAND_NONE;
+
+    if ((s->fs > 1u) && (bitClkFreq > (1u << SERVO_FREQ_Q))) {
+        total = (int64)s->initialDiv + s->divAdj;
+        err = ((int64)s->fs << SERVO_FREQ_Q) - bitClkFreq;
+        gain = fresh ? 1u : 0u;
+
+        if (fresh) {
+            servoTrackLock(s, err);
+        }
+
+        if (ABS(err)*100 > ((int64)s->fs << SERVO_FREQ_Q)) {
+            /* Rapid (coarse) frequency adjustment. */
+            total += divCorrection(total, err, bitClkFreq, SERVO_GAIN_COARSE*gain);
+            s->band = SERVO_BAND_COARSE;
+        } else if (ABS(err)*150 > ((int64)s->fs << SERVO_FREQ_Q)) {
+            /* Slower (fine) frequency adjustment. */
+            total += divCorrection(total, err, bitClkFreq, SERVO_GAIN_FINE*gain);
+            s->band = SERVO_BAND_FINE;
+        } else {
+            /* Precise frequency adjustment. */
+            total += divCorrection(total, err, bitClkFreq, SERVO_GAIN_PRECISE*gain);
+            s->band = SERVO_BAND_PRECISE;
+
+            s->clockAdjust = 0;
+            avgErr = (int32)s->distAverage - SERVO_DIST(s->target);
+            tic = (int32)(((uint64)ABS(avgErr) * 30u + (1u << (SERVO_DIST_Q-1u))) >> SERVO_DIST_Q);
+
+            /* Buffered data size based precise adjustment. */
+            /* If buffered data size is over the target and still increasing, then set the clock faster (increase the divider). */
+            if (avgErr > SERVO_DIST(SERVO_UPPER_RANGE(s))) {
+                total += tic;
+                s->clockAdjust = SERVO_UPPER_RANGE(s);
+            }
+            /* If buffered size is under the target and still decreasing, then set the clock slower (decrease the divider). */
+            if (avgErr < SERVO_DIST(SERVO_LOWER_RANGE(s))) {
+                total -= tic;
+                s->clockAdjust = SERVO_LOWER_RANGE(s);
+            }
+        }
+
+        /* Keep divAdj within the range the divider can represent. */
+        total = (total < div_MIN) ? div_MIN : total;
+        total = (total > div_MAX) ? div_MAX : total;
+        s->divAdj = (int32)(total - s->initialDiv);
+
+        if (SERVO_BAND_PRECISE == s->band) {
+            servoLearnAdj(s);
+        }
+    }
+
+    tmpDiv = (int64)s->initialDiv + s->divAdj;
+    if (s->div != (uint32)tmpDiv) {
+        s->div = (uint32)tmpDiv;
+        return 1u;
+    }
+
+    return 0u;
+}
+
+#if (SERVO_PI_CONTROL)
+/*******************************************************************************
+*  PI loop step, every SERVO_PI_PERIOD_MS while the DMAs run. bitClkFreq is the
+*  latest BitClk measurement in Q24.8 Hz, used when fresh is set.
+*  Returns 1 when s->div is changed and has to be written to FracDiv.
+*******************************************************************************/
+uint8 servoControl(CLOCK_SERVO *s, uint32 bitClkFreq, uint8 fresh) {
+    int32 fillErr = (int32)s->distAverage - SERVO_DIST(s->target);
+    int64 p = ((int64)s->kp * fillErr) >> SERVO_PI_INT_Q;
+    int64 step = (int64)s->ki * fillErr;
+    int64 err;
+    int64 offset;
+    int64 total;
+
+    s->band = SERVO_BAND_NONE;
+    if (s->fs <= 1u) {
+        return 0u;
+    }
+    s->band = SERVO_BAND_PI;
+
+    /* Offset of the divider that gives fs by the measurement. */
+    if (fresh && (bitClkFreq > (1u << SERVO_FREQ_Q))) {
+        err = ((int64)s->fs << SERVO_FREQ_Q) - bitClkFreq;
+        servoTrackLock(s, err);
+        offset = (int64)s->div - s->initialDiv + divCorrection(s->div, err, bitClkFreq, SERVO_GAIN_ONE);
+        step += ((offset << SERVO_PI_INT_Q) - s->integrator) >> SERVO_PI_FLL_LOG2;
+    }
+
+    /* Hold the integrator while the divider is at a limit. */
+    total = (int64)s->initialDiv + ((s->integrator + step) >> SERVO_PI_INT_Q) + p;
+    if (((total > div_MAX) && (step > 0)) || ((total < div_MIN) && (step < 0))) {
+        total = (int64)s->initialDiv + (s->integrator >> SERVO_PI_INT_Q) + p;
+    } else {
+        s->integrator += step;
+    }
+    total = (total < div_MIN) ? div_MIN : total;
+    total = (total > div_MAX) ? div_MAX : total;
+
+    s->divAdj = (int32)(s->integrator >> SERVO_PI_INT_Q);
+    s->clockAdjust = (int16)((p > 0x7FFF) ? 0x7FFF : ((p < -0x8000) ? -0x8000 : p));
+    if (servoLocked(s)) {
+        servoLearnAdj(s);
+    }
+
+    if (s->div != (uint32)total) {
+        s->div = (uint32)total;
+        return 1u;
+    }
+
+    return 0u;
+}
+#endif
+
+/*******************************************************************************
+*  Whether BitClk has stayed within SERVO_LOCK_PPM of fs for SERVO_LOCK_COUNT
+*  measurements.
+*******************************************************************************/
+uint8 servoLocked(const CLOCK_SERVO *s) {
+    return (SERVO_LOCK_COUNT <= s->locked) ? 1u : 0u;
+}
+
+/*******************************************************************************
+*  Asynchronous mode feedback. The BitClk is left at its nominal divider and
+*  the host is asked for the measured BitClk based rate (Q24.8 Hz), corrected
+*  by the buffered data size error. The result is stored in s->feedback in
+*  10.14 samples per 1ms frame.
+*******************************************************************************/
+void servoFeedback(CLOCK_SERVO *s, uint32 bitClkFreq) {
+    int32 nominal = (int32)(((uint64)s->fs << SERVO_FB_Q) / 1000u);
+    int32 rate = nominal;
+    int32 limit = nominal >> SERVO_FB_LIMIT_LOG2;
+    int32 avgErr;
+    int32 corr;
+
+    if (bitClkFreq > (1u << SERVO_FREQ_Q)) {
+        rate = (int32)(((uint64)bitClkFreq << (SERVO_FB_Q - SERVO_FREQ_Q)) / 1000u);
+    }
+
+    /* If buffered data size is over the target, then ask for less data, otherwise more. */
+    avgErr = (int32)s->distAverage - SERVO_DIST(s->target);
+    corr = -avgErr / (int32)(1uL << (SERVO_DIST_Q - SERVO_FB_Q + SERVO_FB_GAIN_LOG2));
+    corr = (corr > limit) ? limit : corr;
+    corr = (corr < -limit) ? -limit : corr;
+
+    s->clockAdjust = (int16)corr;
+    s->feedback = (uint32)(rate + corr);
+}
+
+/*******************************************************************************
+*  End-to-end latency [us]: the averaged buffering delay plus the transfer time
+*  of one USB packet. Saturates at 65535us, returns 0 while fs is not known.
+*******************************************************************************/
+uint16 servoLatency(const CLOCK_SERVO *s) {
+    uint64 latency;
+
+    if (0u == s->fs) {
+        return 0u;
+    }
+
+    latency = ((((uint64)s->distAverage * 1000000u) / s->fs) >> SERVO_DIST_Q) + SERVO_USB_FRAME_US;
+    return (latency > 0xFFFFu) ? 0xFFFFu : (uint16)latency;
+}
+
+/*******************************************************************************
+*  Discard the running gate window and the published frequency, and skip the
+*  first BITCLK_START_WAIT counts. Called when the BitClk is (re)started.
+*******************************************************************************/
+void restartBitClkMeasure() {
+    bitClkRestart = 1u;
+}
+
+/*******************************************************************************
+*  Get the latest BitClk based sampling rate in Q24.8 Hz, or 0 when no gate
+*  window has completed since the last restart. *seq is incremented each time
+*  a new value is published.
+*******************************************************************************/
+uint32 getBitClkFrequency(uint32 *seq) {
+    uint32 tmpSeq;
+    uint32 sum;
+
+    /* FreqCapt writes the other slot before publishing it, so retry only if
+    * it published twice meanwhile. */
+    do {
+        tmpSeq = bitClkSeq;
+        sum = bitClkSum[tmpSeq & 1u];
+    } while (tmpSeq != bitClkSeq);
+
+    if (NULL != seq) {
+        *seq = tmpSeq;
+    }
+
+    /* sum counts of (fs*I2S_CLOCK_FACTOR)Hz clock over BITCLK_GATE ms. */
+    return (uint32)((((uint64)sum * (1000u << SERVO_FREQ_Q)) / I2S_CLOCK_FACTOR) >> BITCLK_GATE_LOG2);
+}
+
+/*******************************************************************************
+*  The Interrupt Service Routine for BitClk_Counter capture event (USB SOF).
+*  Counts are summed over BITCLK_GATE SOF periods and the sum is published
+*  through bitClkSum/bitClkSeq. Integer only, so it does not delay VdacDmaDone.
+*******************************************************************************/
+CY_ISR(FreqCapt) {
+    uint32 count;
+    PROFILE_BEGIN(PROFILE_FREQ_ISR);
+
+    /* Measure BitClk Frequency. */
+    count = BitClk_Counter_ReadCounter();
+    BitClk_Counter_ClearFIFO();
+
+    if (0u != bitClkRestart) {
+        bitClkRestart = 0u;
+        bitClkCountWait = BITCLK_START_WAIT;
+        bitClkGateCount = 0u;
+        bitClkGateSum = 0u;
+        bitClkSum[(bitClkSeq + 1u) & 1u] = 0u;
+        bitClkSeq++;
+    }
+
+    if (0u == count) {
+        /* BitClk is stopped. Start a new gate window once it runs again, as
+        * the first count after FracDiv_Start() covers a partial period. */
+        bitClkCountWait = BITCLK_START_WAIT;
+        bitClkGateCount = 0u;
+        bitClkGateSum = 0u;
+    } else if (bitClkCountWait > 0u) {
+        bitClkCountWait--;
+    } else {
+        bitClkGateSum += count;
+        if (++bitClkGateCount >= BITCLK_GATE) {
+            bitClkSum[(bitClkSeq + 1u) & 1u] = bitClkGateSum;
+            bitClkSeq++;
+            bitClkGateCount = 0u;
+            bitClkGateSum = 0u;
+        }
+    }
+
+    PROFILE_END(PROFILE_FREQ_ISR);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,204 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* I2S BitClk generator (FracDiv) servo.
+*
+* The Cortex-M3 has no FPU, so the servo runs entirely in fixed point:
+*  - distAverage is kept in Q16 frames.
+*  - BitClk frequency is given in Q24.8 Hz. It is measured by counting
+*    BitClk_Counter ticks over BITCLK_GATE USB SOF periods, which gives
+*    0.32ppm resolution at 96kHz and 0.7ppm at 44.1kHz.
+*  - The divider adjustment is kept in divider LSBs.
+*
+*******************************************************************************/
+#if !defined(CLOCK_SERVO_H)
+#define CLOCK_SERVO_H
+
+#include <project.h>
+#include "audio_path.h"
+
+/* Configuration for I2S BitClk generator adjustment. */
+#define adjustInterval              (40u)
+#define UpperAdjustRange            (+(int16)transferSize*3/2)
+#define LowerAdjustRange            (-(int16)transferSize*3/2)
+
+#define div_MAX                     0x7fffffffu
+#define div_MIN                     1
+
+/* The FracDiv output is fs*I2S_CLOCK_FACTOR, which has to stay below half of
+ * DIVIDER_SOURCE_FREQ: 12.288MHz at 192kHz (AUDIO_HIGH_RATES) with 16-bit I2S,
+ * initialDiv is then 0.384*div_MAX. BitClk_Counter (16-bit) counts 12288 per
+ * SOF at that rate. */
+#define DIVIDER_SOURCE_FREQ         (32000000)
+
+/* BitClk frequency measurement (reciprocal counting over a gate window). */
+#define BITCLK_GATE_LOG2            (9u)
+#define BITCLK_GATE                 (1u << BITCLK_GATE_LOG2)
+#define BITCLK_START_WAIT           (2u)
+
+/* Frequency correction gains of the three band adjustment [Q8]. A gate
+ * measurement is corrected once, but it spans BITCLK_GATE/adjustInterval
+ * (12.8) adjust intervals, over which the per-interval gains 0.8, 0.4 and 0.1
+ * of the float servo compounded to 1-(1-g)^12.8: 1.0, 0.9985 and 0.740. */
+#define SERVO_GAIN_Q                (8u)
+#define SERVO_GAIN_ONE              (1u << SERVO_GAIN_Q)
+#define SERVO_GAIN_COARSE           (256u)
+#define SERVO_GAIN_FINE             (256u)
+#define SERVO_GAIN_PRECISE          (190u)
+#if (BITCLK_GATE_LOG2 != 9u) || (adjustInterval != 40u)
+#error "Recompute the SERVO_GAIN_xxx for the new gate and adjust interval."
+#endif
+
+/* Fixed-point formats. */
+#define SERVO_DIST_Q                (16u)
+#define SERVO_FREQ_Q                (8u)
+#define SERVO_WEIGHT_Q              (24u)
+
+/* Asynchronous mode feedback. The buffered data size error is fed back over
+ * about 2^SERVO_FB_GAIN_LOG2 frames, limited to 1/2^SERVO_FB_LIMIT_LOG2 of
+ * the nominal rate. */
+#define SERVO_FB_Q                  (14u)
+#define SERVO_FB_GAIN_LOG2          (10u)
+#define SERVO_FB_LIMIT_LOG2         (8u)
+
+/*
+ * Buffered data size target.
+ *  0: Fixed at half of the active ring, +/-UpperAdjustRange dead band.
+ *  1: Adaptive. While the DMAs run, servoTrackJitter() measures how far the
+ *     buffered data size dips below and rises above its moving average, and
+ *     the variance of its packet to packet change. The jitter is the worst dip
+ *     (or SERVO_JITTER_SIGMAS standard deviations if larger) over the last
+ *     SERVO_JITTER_BLOCKS blocks of 2^SERVO_JITTER_BLOCK_LOG2 packets. The
+ *     target is the smallest level that keeps the jitter SERVO_TARGET_MARGIN_US
+ *     above underrun, with a dead band of the margin, but never above the level
+ *     that leaves the worst rise the same margin below overrun, unless that is
+ *     under half of the ring. A target limited that way keeps the fixed
+ *     dead band. It rises at once on a larger dip, and falls at
+ *     SERVO_TARGET_FALL_PPM of fs at most, which keeps the clock offset needed
+ *     to follow it within crystal tolerance. The window survives DMA restarts,
+ *     which start at the target, and is cleared on a rate change.
+ */
+#if !defined(SERVO_ADAPTIVE_TARGET)
+#define SERVO_ADAPTIVE_TARGET       (0u)
+#endif
+#define SERVO_JITTER_BLOCK_LOG2     (8u)
+#define SERVO_JITTER_BLOCKS         (8u)
+#define SERVO_JITTER_SIGMAS         (3u)
+#define SERVO_TARGET_MARGIN_US      (500u)
+#define SERVO_TARGET_FALL_PPM       (100u)
+
+/*
+ * BitClk control in synchronous mode.
+ *  0: Three band adjustment, servoAdjust() every adjustInterval packets.
+ *  1: PI loop, servoControl() every SERVO_PI_PERIOD_MS. The buffered data
+ *     size error is the phase error of a type 2 PLL with natural frequency
+ *     SERVO_PI_BANDWIDTH_MHZ and damping SERVO_PI_DAMPING/1000, scaled at
+ *     each rate into a proportional gain [divider LSBs per frame] and an
+ *     integral gain [divider LSBs per frame per period], both
+ *     Q(SERVO_PI_GAIN_Q). The integrator is the learned offset divAdj. Each
+ *     fresh BitClk measurement also moves it 1/2^SERVO_PI_FLL_LOG2 of the way
+ *     to the offset that measurement implies, which locks the frequency long
+ *     before the buffer alone would. The integrator holds while the divider
+ *     is at div_MIN or div_MAX. It holds the buffered data size on target,
+ *     but locks 2-8 times slower and wanders about 1ppm more than the three
+ *     band adjustment (host/tests/test_servo_pi.c).
+ */
+#if !defined(SERVO_PI_CONTROL)
+#define SERVO_PI_CONTROL            (0u)
+#endif
+#define SERVO_PI_PERIOD_MS          (16u)
+#define SERVO_PI_BANDWIDTH_MHZ      (20u)
+#define SERVO_PI_DAMPING            (1000u)
+#define SERVO_PI_FLL_LOG2           (1u)
+#define SERVO_PI_GAIN_Q             (8u)
+#define SERVO_PI_INT_Q              (SERVO_DIST_Q + SERVO_PI_GAIN_Q)
+
+/* Packet transfer time added to the buffering delay by servoLatency() [us]. */
+#define SERVO_USB_FRAME_US          (1000u)
+
+/* Divider offsets learned per sampling rate. The offset reached in the
+ * precise band is kept for up to SERVO_RATES rates and seeds the divider when
+ * the host selects the rate again. A rate not seen yet starts from the trim,
+ * the offset learned last relative to its nominal divider, since all rates
+ * come from the same source clock. The trim is also kept over power cycles
+ * (clock_trim.h). */
+#define SERVO_RATES                 (8u)
+#define SERVO_RATE_NONE             (0xFFu)
+#define SERVO_TRIM_SCALE            (1000000000)
+
+/* The clock is locked after SERVO_LOCK_COUNT fresh measurements in a row
+ * within SERVO_LOCK_PPM of fs. */
+#define SERVO_LOCK_PPM              (20u)
+#define SERVO_LOCK_COUNT            (16u)
+
+/* Adjustment band selected by the last servoAdjust() call. */
+#define SERVO_BAND_NONE             (0u)
+#define SERVO_BAND_COARSE           (1u)
+#define SERVO_BAND_FINE             (2u)
+#define SERVO_BAND_PRECISE          (3u)
+#define SERVO_BAND_PI               (4u)
+
+typedef struct {
+    uint32 fs;              /* Sampling rate [Hz], 0 for an unused entry. */
+    int32 divAdj;           /* Offset from the nominal divider. */
+} SERVO_RATE;
+
+typedef struct {
+    uint32 fs;              /* Sampling rate [Hz]. */
+    uint32 initialDiv;      /* Nominal FracDiv value for fs. */
+    int32 divAdj;           /* Learned offset from initialDiv. */
+    uint32 div;             /* Value currently written to FracDiv. */
+    uint32 distAverage;     /* Moving average of buffered frames [Q16]. */
+    uint32 weight;          /* Moving average weight (fs/100000*0.01) [Q24]. */
+    uint32 feedback;        /* Async mode feedback value [10.14 samples/frame]. */
+    int16 clockAdjust;      /* Buffer based adjustment direction (feedback correction in async mode, proportional term with SERVO_PI_CONTROL). */
+    uint8 band;             /* SERVO_BAND_xxx */
+    uint16 target;          /* Buffered data size target [frames]. */
+    uint8 rate;             /* Entry of fs in rates[], SERVO_RATE_NONE until learned. */
+    uint8 nextRate;         /* Entry to reuse when rates[] is full. */
+    SERVO_RATE rates[SERVO_RATES];
+    int32 trim;             /* Offset learned last relative to its nominal divider [ppb]. */
+    uint8 locked;           /* Fresh measurements within SERVO_LOCK_PPM in a row. */
+#if (SERVO_PI_CONTROL)
+    int32 kp;               /* Proportional gain [LSB/frame, Q8]. */
+    int32 ki;               /* Integral gain [LSB/frame/period, Q8]. */
+    int64 integrator;       /* divAdj [Q24]. */
+#endif
+#if (SERVO_ADAPTIVE_TARGET)
+    uint16 margin;          /* Safety margin and dead band [frames]. */
+    uint16 fall;            /* Largest target fall per block [frames]. */
+    uint16 jitter;          /* Worst dip over the window [frames]. */
+    uint16 rise;            /* Worst rise over the window [frames]. */
+    uint16 lastDist;        /* Running block statistics. */
+    uint16 blockDip;
+    uint16 blockRise;
+    uint16 blockCount;
+    uint32 blockSumSq;
+    uint8 blockIndex;
+    uint16 windowDip[SERVO_JITTER_BLOCKS];      /* Dip of each block in the window. */
+    uint16 windowRise[SERVO_JITTER_BLOCKS];     /* Rise of each block in the window. */
+#endif
+} CLOCK_SERVO;
+
+/* Function prototype deffinitions. */
+void servoSetRate(CLOCK_SERVO *s, uint32 fs);
+void servoResetAverage(CLOCK_SERVO *s, uint16 dist);
+void servoUpdateAverage(CLOCK_SERVO *s, uint16 dist);
+uint16 servoStartLevel(const CLOCK_SERVO *s);
+#if (SERVO_ADAPTIVE_TARGET)
+void servoTrackJitter(CLOCK_SERVO *s, uint16 dist);
+#endif
+uint8 servoAdjust(CLOCK_SERVO *s, uint32 bitClkFreq, uint8 fresh);
+#if (SERVO_PI_CONTROL)
+uint8 servoControl(CLOCK_SERVO *s, uint32 bitClkFreq, uint8 fresh);
+#endif
+uint8 servoLocked(const CLOCK_SERVO *s);
+void servoFeedback(CLOCK_SERVO *s, uint32 bitClkFreq);
+uint16 servoLatency(const CLOCK_SERVO *s);
+void restartBitClkMeasure(void);
+uint32 getBitClkFrequency(uint32 *seq);
+CY_ISR_PROTO(FreqCapt);
+
+#endif /* CLOCK_SERVO_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,114 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* BitClk divider trim kept in EEPROM over power cycles.
+*
+*******************************************************************************/
+#include "clock_trim.h"
+#include "audio_path.h"
+#include <stddef.h>
+#include <string.h>
+
+#define TRIM_ROW_NONE               (0xFFu)
+#define TRIM_CRC_POLY               (0xEDB88320u)
+
+/* Row of the current record and its contents. */
+static uint8 trimRow = TRIM_ROW_NONE;
+static TRIM_RECORD trimCurrent;
+static uint8 trimSaved = 0u;
+
+/*******************************************************************************
+*  CRC-32 (reflected 0x04C11DB7, as zlib) of size bytes.
+*******************************************************************************/
+static uint32 trimCrc(const uint8 *p, uint8 size) {
+    uint32 crc = 0xFFFFFFFFu;
+    uint8 b;
+
+    while (0u != size--) {
+        crc ^= *p++;
+        for (b = 0u; b < 8u; b++) {
+            crc = (crc >> 1) ^ ((0u != (crc & 1u)) ? TRIM_CRC_POLY : 0u);
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+*  Whether r holds a record of this format.
+*******************************************************************************/
+static uint8 trimValid(const TRIM_RECORD *r) {
+    return ((TRIM_MAGIC == r->magic) && (TRIM_VERSION == r->version) &&
+            (trimCrc((const uint8 *)r, offsetof(TRIM_RECORD, crc)) == r->crc)) ? 1u : 0u;
+}
+
+/*******************************************************************************
+*  Power the EEPROM and find the current record, at the start of a power
+*  cycle. Returns 1 and sets trim when there is one.
+*******************************************************************************/
+uint8 trimLoad(int32 *trim) {
+    TRIM_RECORD r;
+    uint8 i;
+
+    CyEEPROM_Start();
+
+    trimSaved = 0u;
+    trimRow = TRIM_ROW_NONE;
+    for (i = 0u; i < TRIM_ROWS; i++) {
+        (void)memcpy(&r, (const void *)(CY_EEPROM_BASE + (TRIM_FIRST_ROW + i)*CY_EEPROM_SIZEOF_ROW), sizeof(r));
+        if (trimValid(&r) &&
+            ((TRIM_ROW_NONE == trimRow) || ((int32)(r.sequence - trimCurrent.sequence) > 0))) {
+            trimRow = i;
+            trimCurrent = r;
+        }
+    }
+    if (TRIM_ROW_NONE == trimRow) {
+        return 0u;
+    }
+
+    *trim = trimCurrent.trim;
+
+    return 1u;
+}
+
+/*******************************************************************************
+*  Store trim in the row after the current one, subject to the wear rules of
+*  clock_trim.h, and not while audio is streaming. Blocks while the row is
+*  written. Returns 1 when written.
+*******************************************************************************/
+uint8 trimSave(int32 trim) {
+    uint8 row[CY_EEPROM_SIZEOF_ROW] = {0u};
+    TRIM_RECORD r;
+    uint8 next;
+
+    /* The CPU stalls for the row write: never while streaming. */
+    if ((0u != trimSaved) || (0u != USBFS_GetInterfaceSetting(AUDIO_INTERFACE))) {
+        return 0u;
+    }
+    if ((TRIM_ROW_NONE != trimRow) &&
+        (trim - trimCurrent.trim < TRIM_SAVE_PPB) && (trimCurrent.trim - trim < TRIM_SAVE_PPB)) {
+        return 0u;
+    }
+
+    r.magic = TRIM_MAGIC;
+    r.version = TRIM_VERSION;
+    r.reserved = 0u;
+    r.sequence = (TRIM_ROW_NONE == trimRow) ? 0u : trimCurrent.sequence + 1u;
+    r.trim = trim;
+    r.crc = trimCrc((const uint8 *)&r, offsetof(TRIM_RECORD, crc));
+    (void)memcpy(row, &r, sizeof(r));
+
+    next = ((TRIM_ROW_NONE == trimRow) || (trimRow + 1u >= TRIM_ROWS)) ? 0u : trimRow + 1u;
+    trimSaved = 1u;
+    if ((CYRET_SUCCESS != CySetTemp()) ||
+        (CYRET_SUCCESS != CyWriteRowData(CY_SPC_FIRST_EE_ARRAYID, TRIM_FIRST_ROW + next, row))) {
+        return 0u;
+    }
+
+    trimRow = next;
+    trimCurrent = r;
+
+    return 1u;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,52 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* BitClk divider trim kept in EEPROM over power cycles.
+*
+* The servo's trim (the learned offset of the divider source clock relative
+* to its nominal DIVIDER_SOURCE_FREQ, in ppb) seeds the divider at every rate
+* change. trimLoad() at boot gives it the value of the previous run, so the
+* servo starts close to lock instead of from the nominal divider.
+*
+* Each save is a TRIM_RECORD in one EEPROM row, written to the TRIM_ROWS rows
+* from TRIM_FIRST_ROW in turn; the valid record with the highest sequence
+* number is the current one, so an interrupted write leaves the previous
+* record in place. To limit wear, trimSave() writes only
+*  - a trim the servo is locked with (servoLocked()),
+*  - that differs from the stored one by TRIM_SAVE_PPB or more,
+*  - once per power cycle, i.e. per trimLoad().
+* A row write blocks for about 20ms, so trimSave() refuses to write while the
+* host has the audio interface streaming.
+*
+*******************************************************************************/
+#if !defined(CLOCK_TRIM_H)
+#define CLOCK_TRIM_H
+
+#include <project.h>
+
+/* EEPROM rows used, of CY_EEPROM_SIZEOF_ROW bytes. */
+#define TRIM_FIRST_ROW              (0u)
+#define TRIM_ROWS                   (8u)
+
+#define TRIM_MAGIC                  (0x4D54u)
+#define TRIM_VERSION                (1u)
+#define TRIM_SAVE_PPB               (1000)
+
+/* Record, 16 bytes to fit one EEPROM row. crc is the CRC-32 of the bytes
+ * before it. */
+typedef struct {
+    uint16 magic;           /* TRIM_MAGIC */
+    uint8 version;          /* TRIM_VERSION */
+    uint8 reserved;
+    uint32 sequence;        /* Incremented by each save. */
+    int32 trim;             /* [ppb] */
+    uint32 crc;
+} TRIM_RECORD;
+
+/* Function prototype deffinitions. */
+uint8 trimLoad(int32 *trim);
+uint8 trimSave(int32 trim);
+
+#endif /* CLOCK_TRIM_H */
+
+/* [] END OF FILE */
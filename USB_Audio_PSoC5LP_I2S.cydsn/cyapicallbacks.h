@@ -15,6 +15,35 @@
     /*Define your macro callbacks here */
     /*For more information, refer to the Macro Callbacks topic in the PSoC Creator Help.*/
 
+    /* USB OUT endpoint (EP2) handling.
+     *  0: The main loop polls the endpoint and runs the receive stage.
+     *  1: The USBFS ISRs run the receive stage, so that slow main loop work
+     *     (LCD, debug print) does not delay packet service.
+     * Mode 1 stays disabled until it has been measured on the board with the
+     * profiler (PROFILE_EP_READ/PROFILE_CONVERT against PROFILE_VDAC_ISR):
+     *  - The conversion of up to 192 frames then runs at the USBFS interrupt
+     *    priority, where it can hold off VdacDmaDone and FreqCapt. Polled,
+     *    a packet waits for the longest main loop pass: host/audio_sim -s
+     *    (make bench) misses 5 packets in each 5.5ms stall, as blocking
+     *    prints of a rate change at 115200 baud take, and none from the
+     *    ISRs. Without blocking prints the main loop keeps up.
+     *  - With manual DMA the packet copy is started from the EP2 ISR and
+     *    finished from USBFS_ARB_ISR_ExitCallback, i.e. it relies on the
+     *    arbiter interrupt of the component raising on the DMA completion and
+     *    on the ARB ISR exit callback of the USBFS component in use. Neither
+     *    has been verified with the component version of this project. */
+    #if !defined(AUDIO_OUT_ISR_MODE)
+        #define AUDIO_OUT_ISR_MODE          (0u)
+    #endif
+
+    #if (AUDIO_OUT_ISR_MODE)
+        #define USBFS_EP_2_ISR_EXIT_CALLBACK
+        void USBFS_EP_2_ISR_ExitCallback(void);
+
+        #define USBFS_ARB_ISR_EXIT_CALLBACK
+        void USBFS_ARB_ISR_ExitCallback(void);
+    #endif
+
     
 #endif /* CYAPICALLBACKS_H */   
 /* [] */
@@ -0,0 +1,143 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Deferred binary debug log over the DP UART.
+*
+*******************************************************************************/
+#include "debug_log.h"
+#include "audio_ring.h"
+#include "profiler.h"
+#if (DEBUG_LOG_TEXT)
+#include <stdio.h>
+#endif
+
+#if (DLOG_BUFFER_SIZE & (DLOG_BUFFER_SIZE - 1u)) || (DLOG_BUFFER_SIZE > 0x8000u)
+#error "DLOG_BUFFER_SIZE has to be a power of two of at most 32768."
+#endif
+
+#if (DEBUG_LOG_TEXT)
+#define DLOG_STRING(id, format)     format,
+static const char8 * const debugLogFormat[DLOG_FORMAT_COUNT] = {
+    DLOG_FORMATS(DLOG_STRING)
+};
+
+/* Text print buffer. */
+static char8 debugLogText[256];
+#else
+/* Record ring, written by debugLogWrite() and drained by debugLogDrain(). */
+static uint8 debugLogBuffer[DLOG_BUFFER_SIZE];
+static AUDIO_RING debugLogRing;
+
+/* Records dropped and not yet reported by DLOG_LOST. */
+static uint32 debugLogLost = 0u;
+
+#define DLOG_HEADER_SIZE            (7u)
+#define DLOG_RECORD_SIZE(argc)      (DLOG_HEADER_SIZE + 4u*(argc))
+
+/*******************************************************************************
+*  Copy a record into the ring at position pos. Returns the position after it.
+*******************************************************************************/
+static uint16 debugLogPut(uint16 pos, uint8 id, uint8 argc, uint32 timestamp, const uint32 *argv) {
+    uint16 mask = debugLogRing.mask;
+    uint8 i;
+    uint8 b;
+
+    debugLogBuffer[pos++ & mask] = DLOG_SYNC;
+    debugLogBuffer[pos++ & mask] = id;
+    debugLogBuffer[pos++ & mask] = argc;
+    for (b = 0u; b < 32u; b += 8u) {
+        debugLogBuffer[pos++ & mask] = (uint8)(timestamp >> b);
+    }
+    for (i = 0u; i < argc; i++) {
+        for (b = 0u; b < 32u; b += 8u) {
+            debugLogBuffer[pos++ & mask] = (uint8)(argv[i] >> b);
+        }
+    }
+
+    return pos;
+}
+#endif
+
+/*******************************************************************************
+*  Start the DP UART and log the timestamp clock.
+*******************************************************************************/
+void initDebugLog() {
+#if (!DEBUG_LOG_TEXT)
+    ringInit(&debugLogRing, DLOG_BUFFER_SIZE);
+    startCycleCounter();
+#endif
+
+    DP_Start();
+    DLOG(DLOG_CLOCK, BCLK__BUS_CLK__HZ);
+}
+
+/*******************************************************************************
+*  Log a record of format id with argc arguments of argv. Callable from the
+*  main loop and ISRs.
+*******************************************************************************/
+void debugLogWrite(uint8 id, uint8 argc, const uint32 *argv) {
+#if (DEBUG_LOG_TEXT)
+    uint32 args[DLOG_MAX_ARGS] = {0u};
+    uint8 i;
+
+    for (i = 0u; (i < argc) && (i < DLOG_MAX_ARGS); i++) {
+        args[i] = argv[i];
+    }
+    sprintf(debugLogText, debugLogFormat[id], args[0], args[1], args[2], args[3]);
+    DP_PutString(debugLogText);
+#else
+    uint8 intr;
+    uint16 head;
+    uint16 size;
+    uint32 timestamp;
+    PROFILE_BEGIN(PROFILE_LOG);
+
+    if (argc > DLOG_MAX_ARGS) {
+        argc = DLOG_MAX_ARGS;
+    }
+
+    intr = CyEnterCriticalSection();
+    timestamp = PROFILER_CYCLES();
+
+    /* Report earlier drops ahead of the record. */
+    size = DLOG_RECORD_SIZE(argc);
+    if (0u != debugLogLost) {
+        size += DLOG_RECORD_SIZE(1u);
+    }
+
+    if (ringSpace(&debugLogRing) < size) {
+        debugLogLost++;
+    } else {
+        head = debugLogRing.head;
+        if (0u != debugLogLost) {
+            head = debugLogPut(head, DLOG_LOST, 1u, timestamp, &debugLogLost);
+            debugLogLost = 0u;
+        }
+        debugLogPut(head, id, argc, timestamp, argv);
+        ringPublish(&debugLogRing, size);
+    }
+    CyExitCriticalSection(intr);
+
+    PROFILE_END(PROFILE_LOG);
+#endif
+}
+
+/*******************************************************************************
+*  Move logged bytes into the UART TX FIFO while it has room. Call from the
+*  main loop.
+*******************************************************************************/
+void debugLogDrain() {
+#if (!DEBUG_LOG_TEXT)
+    uint16 n = 0u;
+    uint16 tail = ringTailIndex(&debugLogRing);
+    uint16 fill = ringFill(&debugLogRing);
+
+    while ((n < fill) && (0u != (DP_ReadTxStatus() & DP_TX_STS_FIFO_NOT_FULL))) {
+        DP_WriteTxData(debugLogBuffer[(tail + n) & debugLogRing.mask]);
+        n++;
+    }
+    ringRelease(&debugLogRing, n);
+#endif
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,85 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Deferred binary debug log over the DP UART.
+*
+* DLOG(id, args...) stores a record of the format id, a timestamp and up to
+* DLOG_MAX_ARGS 32-bit arguments into a RAM ring without formatting, and
+* debugLogDrain() moves the ring into the UART TX FIFO from the idle part of
+* the main loop, so logging does not block the packet path. A record that does
+* not fit is dropped and counted, and the count is logged as DLOG_LOST once
+* the ring has room again.
+*
+* Record, little endian:
+*   DLOG_SYNC, id, number of arguments, timestamp (4 bytes), arguments (4 each)
+* The timestamp is the DWT cycle counter at BCLK__BUS_CLK__HZ, which is logged
+* as DLOG_CLOCK at start. tools/dlog_decode.py rebuilds the text from the
+* format table below, which is the only place the strings live; the firmware
+* does not carry them unless DEBUG_LOG_TEXT is set.
+*
+*******************************************************************************/
+#if !defined(DEBUG_LOG_H)
+#define DEBUG_LOG_H
+
+#include <project.h>
+
+/*
+ * Debug log output.
+ *  0: Binary records drained in idle time.
+ *  1: Text formatted and sent at once (blocking), no decoder needed.
+ */
+#define DEBUG_LOG_TEXT              (0u)
+
+/* RAM ring size [bytes], a power of two. */
+#define DLOG_BUFFER_SIZE            (512u)
+#define DLOG_MAX_ARGS               (4u)
+#define DLOG_SYNC                   (0xA5u)
+
+/* Format table: X(id, printf format). Append only, the decoder reads it from
+ * this file and the ids are the order of the entries. */
+#define DLOG_FORMATS(X) \
+    X(DLOG_CLOCK,           "[BusClk=%luHz]\n") \
+    X(DLOG_LOST,            "\n[%lu records lost]\n") \
+    X(DLOG_START,           "\n\n" \
+                            "========================================\n" \
+                            " PSoC USB Audio start.\n" \
+                            "========================================\n" \
+                            "BUFFER_SIZE=%d\n" \
+                            "Sizeof(EZI2C_buf)=%d\n" \
+                            "Offset(EZI2C_buf.page)=%d\n") \
+    X(DLOG_AUDIO_ON,        "Audio=[ON] Alt=[%d]\n") \
+    X(DLOG_AUDIO_OFF,       "\nAudio=[OFF]\n") \
+    X(DLOG_INITIAL_DIV,     "InitialDiv=[%lu]\n") \
+    X(DLOG_NOMINAL_FREQ,    "NominalFreq=[%lu.%03luMHz]\n") \
+    X(DLOG_FREQ,            "Freq=[%2lu.%01lukHz]\n") \
+    X(DLOG_LATENCY,         "\nLatency=[%d] Ring=[%dx%d]\n") \
+    X(DLOG_USB_DROP,        "USB_DROP") \
+    X(DLOG_DMA_START,       "\nDMA Clock START dist=%d\n") \
+    X(DLOG_SERVO_COARSE,    "0") \
+    X(DLOG_SERVO_FINE,      "1") \
+    X(DLOG_DMA_STOP,        "DMA_STOP") \
+    X(DLOG_USB_CONFIGURED,  "USB configured after %lums\n") \
+    X(DLOG_DIV_SEED,        "DivSeed=[%d]\n") \
+    X(DLOG_TRIM_LOAD,       "Trim=[%dppb] loaded\n") \
+    X(DLOG_TRIM_SAVE,       "Trim=[%dppb] saved\n") \
+    X(DLOG_CONCEAL,         "CONCEAL")
+
+#define DLOG_ENUM(id, format)       id,
+enum {
+    DLOG_FORMATS(DLOG_ENUM)
+    DLOG_FORMAT_COUNT
+};
+
+/* Log a record. The arguments are converted to uint32, so %d prints them as
+ * int32 and %lu as uint32. */
+#define DLOG(id, ...)               {const uint32 dlogArgs[] = {0u, ##__VA_ARGS__}; \
+                                     debugLogWrite((id), sizeof(dlogArgs)/sizeof(uint32) - 1u, &dlogArgs[1]);}
+
+/* Function prototype deffinitions. */
+void initDebugLog(void);
+void debugLogWrite(uint8 id, uint8 argc, const uint32 *argv);
+void debugLogDrain(void);
+
+#endif /* DEBUG_LOG_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,267 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Framebuffer driver for the 16x2 CharLCD.
+*
+*******************************************************************************/
+#include "lcd_frame.h"
+#include "tick.h"
+
+#define LCD_NO_CELL                 (0xFFu)
+#define LCD_GLYPH_CELL              (0xFEu)
+
+/* Init sequence of CharLCD_Init(): instruction and flags (LCD_UPPER_ONLY for
+ * the 8-bit mode instructions sent as an upper nibble). Each is followed by
+ * CharLCD_INIT_CMD_DELAY ms; the first waits CharLCD_INIT_DELAY ms for power
+ * up before it. */
+#define LCD_UPPER_ONLY              (0x01u)
+static const uint8 CYCODE lcdInitSequence[][2] = {
+    {CharLCD_DISPLAY_8_BIT_INIT,    LCD_UPPER_ONLY},
+    {CharLCD_DISPLAY_8_BIT_INIT,    LCD_UPPER_ONLY},
+    {CharLCD_DISPLAY_8_BIT_INIT,    LCD_UPPER_ONLY},
+    {CharLCD_DISPLAY_4_BIT_INIT,    LCD_UPPER_ONLY},
+    {CharLCD_DISPLAY_4_BIT_INIT,    0u},
+    {CharLCD_CLEAR_DISPLAY,         0u},
+    {CharLCD_CURSOR_AUTO_INCR_ON,   0u},
+    {CharLCD_DISPLAY_ON_CURSOR_OFF, 0u}
+};
+#define LCD_INIT_STEPS              (sizeof(lcdInitSequence)/sizeof(lcdInitSequence[0]))
+
+/* Init step to send next, when the last one was started [tick], and whether
+ * the sequence is done. */
+static uint8 lcdInitStep;
+static uint32 lcdStepTime;
+static uint8 lcdReady = 0u;
+
+/* Frame written by lcdPrint() and the cells the display shows. */
+static char8 lcdFrame[LCD_CELLS];
+static char8 lcdShown[LCD_CELLS];
+
+/* Cell the display address counter points to, and where the diff resumes. */
+static uint8 lcdCursor = LCD_NO_CELL;
+static uint8 lcdScan = 0u;
+
+/* Transfer in progress. The packet has to stay intact until it completes. */
+static uint8 lcdPacket[LCD_PACKET_SIZE];
+static uint8 lcdPending = LCD_NO_CELL;
+static char8 lcdPendingChar;
+
+/* Glyphs being loaded, NULL when none, and the next byte to send. */
+static const uint8 *lcdGlyphs = NULL;
+static uint8 lcdGlyphIndex;
+
+/*******************************************************************************
+*  Start the I2C master and clear the frame. The display itself is initialized
+*  by lcdService() in the background; needs initTick().
+*******************************************************************************/
+void initLcd() {
+    uint8 i;
+
+    I2C_CharLCD_Start();
+
+    /* The init sequence clears the display and homes the cursor. */
+    for (i = 0u; i < LCD_CELLS; i++) {
+        lcdFrame[i] = ' ';
+        lcdShown[i] = ' ';
+    }
+    lcdCursor = 0u;
+    lcdInitStep = 0u;
+    lcdStepTime = tickCount;
+    lcdReady = 0u;
+}
+
+/*******************************************************************************
+*  Write str into the frame from row/column, clipped at the end of the row.
+*******************************************************************************/
+void lcdPrint(uint8 row, uint8 column, const char8 *str) {
+    if (row >= LCD_ROWS) {
+        return;
+    }
+    while (('\0' != *str) && (column < LCD_COLUMNS)) {
+        lcdFrame[row*LCD_COLUMNS + column++] = *str++;
+    }
+}
+
+/*******************************************************************************
+*  Load glyphs[LCD_GLYPH_BYTES] into the custom characters. glyphs has to stay
+*  valid until they are sent.
+*******************************************************************************/
+void lcdLoadGlyphs(const uint8 *glyphs) {
+    lcdGlyphs = glyphs;
+    lcdGlyphIndex = 0u;
+}
+
+/*******************************************************************************
+*  Put the PCF8574 bytes of an instruction (rs = 0) or a character
+*  (rs = CharLCD_RSH). Returns the number of bytes.
+*******************************************************************************/
+static uint8 lcdPutInstruction(uint8 *p, uint8 byte, uint8 rs) {
+    uint8 upper = (byte & CharLCD_UPPER_NIB_MASK) | CharLCD_BLH | rs;
+    uint8 lower = (uint8)((byte & CharLCD_LOWER_NIB_MASK) << CharLCD_LOWER_NIB_SHIFT) | CharLCD_BLH | rs;
+    uint8 i;
+
+    p[0] = upper | CharLCD_EH;
+    p[1] = upper;
+    p[2] = lower | CharLCD_EH;
+    p[3] = lower;
+
+    /* Keep E low while the instruction executes. */
+    for (i = LCD_NIBBLE_BYTES; i < LCD_INSTRUCTION_BYTES; i++) {
+        p[i] = lower;
+    }
+
+    return LCD_INSTRUCTION_BYTES;
+}
+
+/*******************************************************************************
+*  Build the transfer of init step lcdInitStep. Returns the transfer size.
+*******************************************************************************/
+static uint8 lcdInitPacket(uint8 *packet) {
+    uint8 size = lcdPutInstruction(packet, lcdInitSequence[lcdInitStep][0], 0u);
+
+    /* E strobe of the upper nibble only. */
+    if (0u != (lcdInitSequence[lcdInitStep][1] & LCD_UPPER_ONLY)) {
+        size = 2u;
+    }
+
+    return size;
+}
+
+/*******************************************************************************
+*  Build the transfer for the next changed cell into packet[LCD_PACKET_SIZE]
+*  and set cell to it. Returns the transfer size, 0 when the display is up to
+*  date.
+*******************************************************************************/
+uint8 lcdNextPacket(uint8 *packet, uint8 *cell) {
+    uint8 size = 0u;
+    uint8 c = lcdScan;
+    uint8 n;
+
+    for (n = 0u; n < LCD_CELLS; n++) {
+        if (lcdFrame[c] != lcdShown[c]) {
+            break;
+        }
+        c = (c + 1u < LCD_CELLS) ? c + 1u : 0u;
+    }
+    if (LCD_CELLS == n) {
+        return 0u;
+    }
+
+    /* Move the display cursor unless it already is at the cell. */
+    if (c != lcdCursor) {
+        size += lcdPutInstruction(&packet[size],
+            ((c < LCD_COLUMNS) ? CharLCD_ROW_0_START : CharLCD_ROW_1_START) + c%LCD_COLUMNS, 0u);
+    }
+    size += lcdPutInstruction(&packet[size], (uint8)lcdFrame[c], CharLCD_RSH);
+    *cell = c;
+
+    return size;
+}
+
+/*******************************************************************************
+*  Build the transfer of glyph byte lcdGlyphIndex: its CGRAM address, so that a
+*  failed transfer can simply be sent again, and the byte.
+*******************************************************************************/
+static uint8 lcdGlyphPacket(uint8 *packet) {
+    uint8 size;
+
+    size = lcdPutInstruction(packet, CharLCD_CGRAM_0 + lcdGlyphIndex, 0u);
+    size += lcdPutInstruction(&packet[size], lcdGlyphs[lcdGlyphIndex], CharLCD_RSH);
+
+    return size;
+}
+
+/*******************************************************************************
+*  Advance the init sequence. A step is sent once the previous one is complete
+*  and has had its delay, which counts whole ticks so it is never short.
+*******************************************************************************/
+static void lcdServiceInit(void) {
+    uint8 status;
+
+    /* Complete the step in progress. A failed step is sent again. */
+    if (LCD_NO_CELL != lcdPending) {
+        status = I2C_CharLCD_MasterStatus();
+        if (0u == (status & (I2C_CharLCD_MSTAT_WR_CMPLT | I2C_CharLCD_MSTAT_ERR_XFER))) {
+            return;
+        }
+        lcdPending = LCD_NO_CELL;
+        if (0u == (status & I2C_CharLCD_MSTAT_ERR_XFER)) {
+            lcdInitStep++;
+        }
+    }
+
+    if (TICK_ELAPSED(lcdStepTime) <= ((0u == lcdInitStep) ? CharLCD_INIT_DELAY : CharLCD_INIT_CMD_DELAY)) {
+        return;
+    }
+    if (LCD_INIT_STEPS == lcdInitStep) {
+        lcdReady = 1u;
+        return;
+    }
+
+    (void)I2C_CharLCD_MasterClearStatus();
+    if (I2C_CharLCD_MSTR_NO_ERROR == I2C_CharLCD_MasterWriteBuf(CharLCD_I2C_SLAVE_ADDR, lcdPacket,
+                                                                lcdInitPacket(lcdPacket), I2C_CharLCD_MODE_COMPLETE_XFER)) {
+        lcdPending = lcdInitStep;
+        lcdStepTime = tickCount;
+    }
+}
+
+/*******************************************************************************
+*  Complete the transfer in progress and start the next one, an init step
+*  when it is due or a changed cell. Call from the main loop; it does not wait
+*  for the I2C bus or the display.
+*******************************************************************************/
+void lcdService() {
+    uint8 status;
+    uint8 size;
+    uint8 cell;
+
+    if (0u == lcdReady) {
+        lcdServiceInit();
+        return;
+    }
+
+    if (LCD_NO_CELL != lcdPending) {
+        status = I2C_CharLCD_MasterStatus();
+        if (0u == (status & (I2C_CharLCD_MSTAT_WR_CMPLT | I2C_CharLCD_MSTAT_ERR_XFER))) {
+            return;
+        }
+        (void)I2C_CharLCD_MasterClearStatus();
+
+        if (0u != (status & I2C_CharLCD_MSTAT_ERR_XFER)) {
+            /* Where the cursor ended up is unknown. Send the cell again. */
+            lcdCursor = LCD_NO_CELL;
+        } else if (LCD_GLYPH_CELL == lcdPending) {
+            /* The cursor is in CGRAM now. */
+            lcdCursor = LCD_NO_CELL;
+            if (++lcdGlyphIndex >= LCD_GLYPH_BYTES) {
+                lcdGlyphs = NULL;
+            }
+        } else {
+            lcdShown[lcdPending] = lcdPendingChar;
+            lcdScan = (lcdPending + 1u < LCD_CELLS) ? lcdPending + 1u : 0u;
+
+            /* The address counter does not run from row 0 into row 1. */
+            lcdCursor = (0u != lcdScan%LCD_COLUMNS) ? lcdScan : LCD_NO_CELL;
+        }
+        lcdPending = LCD_NO_CELL;
+    }
+
+    if (NULL != lcdGlyphs) {
+        size = lcdGlyphPacket(lcdPacket);
+        cell = LCD_GLYPH_CELL;
+    } else {
+        size = lcdNextPacket(lcdPacket, &cell);
+    }
+    if (0u != size) {
+        /* Drop the status of the previous transfer. */
+        (void)I2C_CharLCD_MasterClearStatus();
+        if (I2C_CharLCD_MSTR_NO_ERROR == I2C_CharLCD_MasterWriteBuf(CharLCD_I2C_SLAVE_ADDR, lcdPacket, size,
+                                                                    I2C_CharLCD_MODE_COMPLETE_XFER)) {
+            lcdPending = cell;
+            lcdPendingChar = (LCD_GLYPH_CELL == cell) ? 0 : lcdFrame[cell];
+        }
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,55 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Framebuffer driver for the 16x2 CharLCD (HD44780 behind a PCF8574 I2C
+* backpack).
+*
+* lcdPrint() only writes the frame in RAM. lcdService(), called from the main
+* loop, compares the frame with what the display shows and sends one changed
+* cell at a time as a single interrupt driven I2C_CharLCD transfer: the DDRAM
+* address when the display cursor is not already there, then the character,
+* each as the four PCF8574 bytes of its E-strobed nibbles. Instead of busy
+* delays, LCD_HOLD_BYTES idle bytes after each instruction cover its 37us
+* execution time at I2C rates up to 400kHz. A cell is marked shown when its
+* transfer completes, so a failed transfer is simply sent again.
+*
+* The display is initialized the same way: lcdService() steps through the
+* CharLCD_Init() sequence, timed by the 1ms tick, so USB enumerates without
+* waiting for it. Cells printed meanwhile are sent once it is done.
+*
+* lcdLoadGlyphs() loads the 8 custom characters into CGRAM in the background
+* too, one byte per transfer, ahead of any cell. They are printed as
+* LCD_GLYPH(0) to LCD_GLYPH(7), the CGRAM aliases at 0x08-0x0F, so that glyph
+* 0 does not end a string.
+*
+*******************************************************************************/
+#if !defined(LCD_FRAME_H)
+#define LCD_FRAME_H
+
+#include <project.h>
+
+#define LCD_ROWS                    (2u)
+#define LCD_COLUMNS                 (16u)
+#define LCD_CELLS                   (LCD_ROWS*LCD_COLUMNS)
+
+/* PCF8574 bytes per instruction: two nibbles, each with E high then low. */
+#define LCD_NIBBLE_BYTES            (4u)
+#define LCD_HOLD_BYTES              (2u)
+#define LCD_INSTRUCTION_BYTES       (LCD_NIBBLE_BYTES + LCD_HOLD_BYTES)
+#define LCD_PACKET_SIZE             (2u*LCD_INSTRUCTION_BYTES)
+
+/* Custom characters: 8 glyphs of 8 rows. */
+#define LCD_GLYPHS                  (8u)
+#define LCD_GLYPH_BYTES             (LCD_GLYPHS*CharLCD_CHARACTER_HEIGHT)
+#define LCD_GLYPH(n)                ((char8)(0x08u + (n)))
+
+/* Function prototype deffinitions. */
+void initLcd(void);
+void lcdPrint(uint8 row, uint8 column, const char8 *str);
+void lcdLoadGlyphs(const uint8 *glyphs);
+uint8 lcdNextPacket(uint8 *packet, uint8 *cell);
+void lcdService(void);
+
+#endif /* LCD_FRAME_H */
+
+/* [] END OF FILE */
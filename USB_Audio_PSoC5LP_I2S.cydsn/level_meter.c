@@ -0,0 +1,128 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Peak/RMS level meter on the second LCD row.
+*
+*******************************************************************************/
+#include "level_meter.h"
+#include "lcd_frame.h"
+#include "tick.h"
+
+#if (AUDIO_LEVEL_METER)
+#if (CharLCD_CUSTOM_CHAR_SET != CharLCD_HORIZONTAL_BG)
+#error "AUDIO_LEVEL_METER needs the CharLCD custom character set set to the horizontal bar graph"
+#endif
+
+/* Glyph n of the component's horizontal bar graph set has its n left columns
+ * lit, up to 5. Glyph 6, blank in the set, becomes the peak marker. */
+#define METER_GLYPH_PEAK            (6u)
+#define METER_PEAK_ROW              (0x04u)
+static uint8 meterGlyphs[LCD_GLYPH_BYTES];
+
+/* Full scale in log2 quarter octaves (32768 = 2^15). */
+#define METER_FULL_SCALE_Q2         (15u*4u)
+#define METER_CLIP_LEVEL            (32767u)
+
+static const char8 meterLabel[AUDIO_CH] = {'L', 'R'};
+
+/* Peak hold per channel [pixels], when it was set and when the channel last
+ * clipped [tick]. */
+static uint8 holdPixels[AUDIO_CH];
+static uint32 holdTime[AUDIO_CH];
+static uint32 clipTime[AUDIO_CH];
+static uint8 clipped[AUDIO_CH];
+static uint32 meterTime;
+
+/*******************************************************************************
+*  Bar length of a level (32768 = full scale): log2 in quarter octaves, the
+*  fraction taken linearly from the two bits below the leading one.
+*******************************************************************************/
+static uint8 meterPixels(uint16 level) {
+    uint32 e;
+    uint32 q2;
+
+    if (0u == level) {
+        return 0u;
+    }
+    e = 31u - __CLZ(level);
+    q2 = e*4u + ((((uint32)level << (31u - e)) >> 29) & 3u);
+    if (q2 + METER_PIXELS <= METER_FULL_SCALE_Q2) {
+        return 0u;
+    }
+
+    return (uint8)(q2 + METER_PIXELS - METER_FULL_SCALE_Q2);
+}
+
+/*******************************************************************************
+*  Load the bar graph glyphs of the CharLCD component and the peak marker.
+*******************************************************************************/
+void initMeter() {
+    uint8 i;
+
+    for (i = 0u; i < LCD_GLYPH_BYTES; i++) {
+        meterGlyphs[i] = (i/CharLCD_CHARACTER_HEIGHT == METER_GLYPH_PEAK) ? METER_PEAK_ROW : CharLCD_customFonts[i];
+    }
+    lcdLoadGlyphs(meterGlyphs);
+    meterTime = tickCount;
+}
+
+/*******************************************************************************
+*  Redraw the meters every METER_INTERVAL_MS. Call from the main loop.
+*******************************************************************************/
+void meterUpdate() {
+    AUDIO_LEVELS lv;
+    char8 text[2u*(1u + METER_CELLS) + 1u];
+    char8 *t = text;
+    uint8 ch;
+    uint8 i;
+    uint8 bar;
+    uint8 peak;
+    uint8 fill;
+
+    if (TICK_ELAPSED(meterTime) < METER_INTERVAL_MS) {
+        return;
+    }
+    meterTime = tickCount;
+
+    getLevels(&lv);
+    for (ch = 0u; ch < AUDIO_CH; ch++) {
+        bar = meterPixels(lv.rms[ch]);
+        peak = meterPixels(lv.peak[ch]);
+
+        /* Peak hold, falling a pixel per interval once expired. */
+        if (peak >= holdPixels[ch]) {
+            holdPixels[ch] = peak;
+            holdTime[ch] = meterTime;
+        } else if ((TICK_ELAPSED(holdTime[ch]) >= METER_HOLD_MS) && (0u != holdPixels[ch])) {
+            holdPixels[ch]--;
+        }
+
+        if (lv.peak[ch] >= METER_CLIP_LEVEL) {
+            clipTime[ch] = meterTime;
+            clipped[ch] = 1u;
+        } else if (TICK_ELAPSED(clipTime[ch]) >= METER_CLIP_MS) {
+            clipped[ch] = 0u;
+        }
+
+        *t++ = (0u != clipped[ch]) ? '!' : meterLabel[ch];
+        for (i = 0u; i < METER_CELLS; i++) {
+            fill = (bar > i*CharLCD_CHARACTER_WIDTH) ? bar - i*CharLCD_CHARACTER_WIDTH : 0u;
+            fill = (fill > CharLCD_CHARACTER_WIDTH) ? CharLCD_CHARACTER_WIDTH : fill;
+            *t++ = LCD_GLYPH(fill);
+        }
+
+        /* Mark the held peak in the first empty cell it falls into. */
+        if (holdPixels[ch] > bar) {
+            i = (holdPixels[ch] - 1u)/CharLCD_CHARACTER_WIDTH;
+            if (i*CharLCD_CHARACTER_WIDTH >= bar) {
+                t[(int)i - (int)METER_CELLS] = LCD_GLYPH(METER_GLYPH_PEAK);
+            }
+        }
+    }
+    *t = '\0';
+
+    lcdPrint(METER_ROW, 0u, text);
+}
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,34 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Peak/RMS level meter on the second LCD row.
+*
+* Every METER_INTERVAL_MS the main loop reads the levels kept by the conversion
+* kernels (getLevels()) and draws one bar per channel, "L" and "R" followed by
+* METER_CELLS cells drawn with the horizontal bar graph glyphs. The bar is the
+* RMS level on a log scale of 6dB per 4 pixels, 0dBFS at the right end
+* and about -52dBFS at the left. A marker shows the peak, held for
+* METER_HOLD_MS and then falling a pixel per interval. The channel letter turns
+* into '!' for METER_CLIP_MS after a sample at full scale.
+*
+*******************************************************************************/
+#if !defined(LEVEL_METER_H)
+#define LEVEL_METER_H
+
+#include <project.h>
+#include "audio_path.h"
+
+#define METER_ROW                   (1u)
+#define METER_CELLS                 (7u)
+#define METER_PIXELS                (METER_CELLS*CharLCD_CHARACTER_WIDTH)
+#define METER_INTERVAL_MS           (100u)
+#define METER_HOLD_MS               (1500u)
+#define METER_CLIP_MS               (2000u)
+
+/* Function prototype deffinitions. */
+void initMeter(void);
+void meterUpdate(void);
+
+#endif /* LEVEL_METER_H */
+
+/* [] END OF FILE */
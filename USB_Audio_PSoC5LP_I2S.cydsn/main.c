@@ -5,175 +5,112 @@
 *
 *******************************************************************************/
 #include <project.h>
+#include "audio_path.h"
+#include "clock_servo.h"
+#include "clock_trim.h"
+#include "telemetry.h"
+#include "profiler.h"
+#include "debug_log.h"
+#include "lcd_frame.h"
+#include "tick.h"
+#include "level_meter.h"
 #include <stdio.h>
-#include <math.h>
-
-/* UBSFS device constants. */
-#define USBFS_AUDIO_DEVICE  (0u)
-#define AUDIO_INTERFACE     (1u)
-#define OUT_EP_NUM          (2u)
-#define AUDIO_CH            (2u)
-#define BYTES_PER_CH        (2u)
-#define USB_BUF_SIZE        (384u)
-
-/* Audio buffer constants. */
-#define TRANSFER_SIZE       (USB_BUF_SIZE/AUDIO_CH/BYTES_PER_CH)
-#define NUM_OF_BUFFERS      (10u)
-#define BUFFER_SIZE         (TRANSFER_SIZE * NUM_OF_BUFFERS)
-#define sHALF_BUFFER_SIZE   ((int16)(BUFFER_SIZE/2u))
-
-#define I2S_CLOCK_FACTOR    (I2S_DATA_BITS*AUDIO_CH*2)
-#define I2S_DATA_SIZE       (I2S_DATA_BITS/8*AUDIO_CH)
-#define I2S_TRANSFER_SIZE   (TRANSFER_SIZE*I2S_DATA_SIZE)
-#define I2S_BUFFER_SIZE     (I2S_TRANSFER_SIZE * NUM_OF_BUFFERS)
-
-/* Circular buffer for audio stream. */
-uint8 tmpEpBuf[USB_BUF_SIZE];
-uint8 soundBuffer_L[BUFFER_SIZE];
-uint8 soundBuffer_R[BUFFER_SIZE];
-uint8 soundBuffer_I2S[I2S_BUFFER_SIZE];
-volatile uint16 outIndex = 0u;
-volatile uint16 inIndex = 0u;
-#define BUFFERED_DATA_SIZE          ((BUFFER_SIZE+inIndex - outIndex*TRANSFER_SIZE)%BUFFER_SIZE)
 
 /* DMA sync flag. */
 volatile uint8 syncDma = 0u;
 
-/* Variables for VDACoutDMA. */
-uint8 VdacOutDmaCh_L;
-uint8 VdacOutDmaCh_R;
-uint8 VdacOutDmaTd_L[NUM_OF_BUFFERS];
-uint8 VdacOutDmaTd_R[NUM_OF_BUFFERS];
-
-/* DMA Configuration for VDACoutDMA (Memory to VDAC) */
-#define VDAC_DMA_BYTES_PER_BURST    (1u)
-#define VDAC_DMA_REQUEST_PER_BURST  (1u)
-#define VDAC_DMA_TD_TERMOUT_EN      (VdacDma_L__TD_TERMOUT_EN)
-#define VDAC_DMA_DST_BASE           (CYDEV_PERIPH_BASE)
-#define VDAC_DMA_SRC_BASE_L         (CY_PSOC5LP) ? ((uint32) soundBuffer_L) : (CYDEV_SRAM_BASE)
-#define VDAC_DMA_SRC_BASE_R         (CY_PSOC5LP) ? ((uint32) soundBuffer_R) : (CYDEV_SRAM_BASE)
-#define VDAC_DMA_ENABLE_PRESERVE_TD (1u)
-
-/* Variables for I2S_DMA. */
-uint8 I2SDmaCh;
-uint8 I2SDmaTd[NUM_OF_BUFFERS];
-
-/* DMA Configuration for I2S_DMA (Memory to I2S) */
-#define I2S_DMA_BYTES_PER_BURST    (1u)
-#define I2S_DMA_REQUEST_PER_BURST  (1u)
-#define I2S_DMA_TD_TERMOUT_EN      (I2S_DMA__TD_TERMOUT_EN)
-#define I2S_DMA_DST_BASE           (CYDEV_PERIPH_BASE)
-#define I2S_DMA_SRC_BASE           (CY_PSOC5LP) ? ((uint32) soundBuffer_I2S) : (CYDEV_SRAM_BASE)
-#define I2S_DMA_ENABLE_PRESERVE_TD (1u)
-
-/* Configuration for I2S BitClk generator adjustment. */
-#define adjustInterval              (40u)
-#define adjustTic                   (fabs(distAverage-sHALF_BUFFER_SIZE)*30.0)
-#define UpperAdjustRange            (+(int16)TRANSFER_SIZE*3/2)
-#define LowerAdjustRange            (-(int16)TRANSFER_SIZE*3/2)
-#define MovingAverageWeight         (fs/100000.0*0.01)
-#define SGN(x)                      (((x) < 0) ? -1 : (((x) > 0) ? 1 : 0))
-
-#define div_MAX                     0x7fffffffu
-#define div_MIN                     1
-
-#define DIVIDER_SOURCE_FREQ         (32000000)
-
-/* Variables for BitClk frequency counter. */
-volatile float bitClkFrequency = 0;
-volatile uint32 bitClkCountWait = 0;
-float tmpBitClkFreq;
-
-/* Debug print buffer. */
-char dbuf[256];
-#define DP(...)                     {sprintf(dbuf, __VA_ARGS__); DP_PutString(dbuf);}
-
-/* EZI2C buffer watched by external device (PC). */
-struct _EZI2C_buf {
-    float bitClkFreqency;
-    uint32 div;
-    uint16 dist;
-    uint16 distAvrerage;
-    int16 clockAdjust;
-    int16 inOutDiffVDAC;
-    int16 inOutDiffI2S;
-    uint8 L;
-    uint8 R;
-    uint8 flag;
-} EZI2C_buf;
-
-/*
- * Operation Flag.
- *  bit 0 => (unused)
- *  bit 1 => DMA for VDAC is stopped due to buffer under-run.
- *  bit 2 => USB packet is dropped due to buffer over-run.
- */
-volatile uint8 flag = 0u;
-#define DMA_STOP_FLAG            (1u<<1)
-#define USB_DROP_FLAG            (1u<<2)
+/* LCD print buffer. */
+char dbuf[32];
 
 /* Function prototype deffinitions. */
 void initComponents(void);
-void initDMAs(void);
-uint16 getOutIndexVDAC(void);
-uint16 getOutIndexI2S(void);
-CY_ISR_PROTO(VdacDmaDone);
-CY_ISR_PROTO(FreqCapt);
 
 /*******************************************************************************
 * main
 *******************************************************************************/
 int main() {
-    uint16 i;
-    uint16 readSize;
+    uint8 intr;
+    uint8 altSetting;
+
+    /* Active latency profile. */
+    uint8 profile = LATENCY_PROFILE_DEEP;
+    uint8 tmpProfile;
+    uint8 rebuildProfile = 0u;
+
+    /* Variables for the receive stage status. */
+    uint8 rxCount;
+    uint8 lastRxCount = 0u;
+    uint8 rxDrop;
+    uint8 lastRxDrop = 0u;
+    uint16 tmpDist;
 
     /* Current sampling rate specified by USB host. */
-    float fs;
+    uint32 fs = 0u;
 
-    /* Variables for BitClk generator */
-    uint32 initialDiv;
-    float divAdj = 0;
-    uint32 div;
-    uint32 tmpDiv = 0;
+    /* BitClk generator servo. */
+    CLOCK_SERVO servo = {0u};
 
     /* Variables for BitClk frequency control. */
     uint16 dist0;
-    uint16 dist;
-    float distAverage;
+    uint16 dist = 0u;
+#if (SERVO_PI_CONTROL) && (!AUDIO_ASYNC_MODE)
+    uint32 servoTime = 0u;
+#else
     uint16 adjustIntervalCount = 0u;
-    int16 clockAdjust = 0;
-    float bitClkFreq;
+#endif
+    uint32 bitClkFreq;
+    uint32 bitClkSeq;
+#if (!AUDIO_ASYNC_MODE)
+    uint32 lastBitClkSeq = 0u;
+#endif
 
     /* Variables used to manage DMA. */
     uint16 currentOutIndexVDAC = 0u;
     uint16 currentOutIndex = 0u;
 
+    /* Servo state history entry. */
+    TELEMETRY_ENTRY *entry;
+
     /* Initialize components. */
     initComponents();
 
-    DP("\n\n");
-    DP("========================================\n");
-    DP(" PSoC USB Audio start.\n");
-    DP("========================================\n");
-    DP("BUFFER_SIZE=%d\n", BUFFER_SIZE);
-    DP("Sizeof(EZI2C_buf)=%d\n", sizeof(EZI2C_buf));
+    DLOG(DLOG_START, BUFFER_SIZE, sizeof(EZI2C_buf), offsetof(struct _EZI2C_buf, page));
+
+    /* Start the divider from the trim learned in the previous run. */
+    if (trimLoad(&servo.trim)) {
+        DLOG(DLOG_TRIM_LOAD, servo.trim);
+    }
 
     /* Start USBFS Operation with 5V operation. */
     USBFS_Start(USBFS_AUDIO_DEVICE, USBFS_5V_OPERATION);
 
     /* Wait for device enumeration. */
     while (0u == USBFS_GetConfiguration()) {
+        debugLogDrain();
+        lcdService();
     }
+    DLOG(DLOG_USB_CONFIGURED, tickCount);
 
     /*******************************************************************************
     * Main loop.
     *******************************************************************************/
     for (;;) {
+        /* Send logged records and LCD changes in idle time. */
+        debugLogDrain();
+        PROFILE_BEGIN(PROFILE_LCD);
+#if (AUDIO_LEVEL_METER)
+        meterUpdate();
+#endif
+        lcdService();
+        PROFILE_END(PROFILE_LCD);
+
         /* Check if configuration or interface settings are changed. */
         if (0u != USBFS_IsConfigurationChanged()) {
             /* Check active alternate setting. */
             if ( (0u != USBFS_GetConfiguration()) && (0u != USBFS_GetInterfaceSetting(AUDIO_INTERFACE)) ) {
-                /* Alternate settings 1: Audio is streaming. */
+                /* Alternate settings 1-3: Audio is streaming (16/24/32-bit). */
+                altSetting = USBFS_GetInterfaceSetting(AUDIO_INTERFACE);
+                setAudioFormat(altSetting);
 
                 /* Reset VDAC output level. */
                 VDAC8_L_Data = 128u;
@@ -181,34 +118,44 @@ int main() {
 
                 /* Reset variables. */
                 syncDma = 0u;
+#if (!SERVO_PI_CONTROL) || (AUDIO_ASYNC_MODE)
                 adjustIntervalCount = 0u;
-                bitClkFrequency = 0;
-                bitClkCountWait = 2;
+#endif
+                restartBitClkMeasure();
 
                 /* Enable OUT endpoint to receive audio stream. */
-                USBFS_EnableOutEP(OUT_EP_NUM);
+                enableOutPacket();
 
-                CharLCD_Position(0u, 0u);
-                CharLCD_PrintString("Audio ON ");
-                DP("Audio=[ON]\n");
+                lcdPrint(0u, 0u, "Audio ON ");
+                DLOG(DLOG_AUDIO_ON, altSetting);
             } else {
                 /* Alternate settings 0: Audio is not streaming (mute). */
 
                 /* Stop BitClk generator to stop DMA transfer. */
                 FracDiv_Stop();
+#if (AUDIO_CONCEAL)
+                /* The receive stage may run in the USB ISR. */
+                intr = CyEnterCriticalSection();
+                resetConceal();
+                CyExitCriticalSection(intr);
+#endif
 
                 /* Reset VDAC output level. */
                 VDAC8_L_Data = 128u;
                 VDAC8_R_Data = 128u;
 
-                CharLCD_Position(0u, 0u);
-                CharLCD_PrintString("Audio OFF");
-                DP("\nAudio=[OFF]\n");
+                lcdPrint(0u, 0u, "Audio OFF");
+                DLOG(DLOG_AUDIO_OFF);
+
+                /* Keep the trim the servo locked with while nothing plays. */
+                if (servoLocked(&servo) && trimSave(servo.trim)) {
+                    DLOG(DLOG_TRIM_SAVE, servo.trim);
+                }
             }
 
             if (USBFS_GetConfiguration() != 0u) {
                 /* Enable OUT endpoint to receive data from host. */
-                USBFS_EnableOutEP(OUT_EP_NUM);
+                enableOutPacket();
             }
         }
 
@@ -217,153 +164,223 @@ int main() {
         *******************************************************************************/
         if ((USBFS_frequencyChanged != 0u) && (USBFS_transferState == USBFS_TRANS_STATE_IDLE)) {
             /* Get current sampling frequency. */
-            float tmpFs = USBFS_currentSampleFrequency[OUT_EP_NUM][0] +
-                          (USBFS_currentSampleFrequency[OUT_EP_NUM][1]<<8) +
-                          (USBFS_currentSampleFrequency[OUT_EP_NUM][2]<<16);
+            uint32 tmpFs = USBFS_currentSampleFrequency[OUT_EP_NUM][0] +
+                           ((uint32)USBFS_currentSampleFrequency[OUT_EP_NUM][1]<<8) +
+                           ((uint32)USBFS_currentSampleFrequency[OUT_EP_NUM][2]<<16);
 
             if (tmpFs != fs) {
-                fs = tmpFs;
+                uint32 nominalFreq;
 
-                initialDiv = fs*I2S_CLOCK_FACTOR*(float)0x7fffffffu/(float)DIVIDER_SOURCE_FREQ;
-                divAdj = 0;
-                div = initialDiv+divAdj;
-                FracDiv_Write(div, 0x7fffffffu);
-
-                DP("InitialDiv=[%ld]\n", div);
-                DP("NominalFreq=[%4.3fMHz]\n", ((float)DIVIDER_SOURCE_FREQ)*div/(float)0x7fffffffu/1000000.0);
+                fs = tmpFs;
 
-                sprintf(dbuf, "%4.1fkHz", fs/1000.0);
-                CharLCD_Position(1u, 0u);
-                CharLCD_PrintString(dbuf);
-                DP(dbuf, "Freq=[%4.1fkHz]\n", fs/1000.0);
+                servoSetRate(&servo, fs);
+                FracDiv_Write(servo.div, 0x7fffffffu);
+
+                /* Chunks are sized by packets of fs. */
+                rebuildProfile = 1u;
+#if (VDAC_NOISE_SHAPING)
+                setVdacShaper(fs);
+#endif
+
+                DLOG(DLOG_INITIAL_DIV, servo.div);
+                DLOG(DLOG_DIV_SEED, servo.divAdj);
+                nominalFreq = (uint32)((uint64)DIVIDER_SOURCE_FREQ*servo.div/div_MAX);
+                DLOG(DLOG_NOMINAL_FREQ, nominalFreq/1000000u, (nominalFreq/1000u)%1000u);
+
+                /* 7 columns: "44.1kHz", " 192kHz". */
+                if (fs >= 100000u) {
+                    sprintf(dbuf, "%4lukHz", fs/1000u);
+                } else {
+                    sprintf(dbuf, "%2lu.%01lukHz", fs/1000u, (fs%1000u)/100u);
+                }
+                lcdPrint(0u, 9u, dbuf);
+                DLOG(DLOG_FREQ, fs/1000u, (fs%1000u)/100u);
 
                 USBFS_frequencyChanged = 0u;
             }
         }
 
         /*******************************************************************************
-        * Receive data from USB and extract into audio buffers.
+        * Apply latency profile requested by external device (PC) through EZI2C.
         *******************************************************************************/
-        if (USBFS_OUT_BUFFER_FULL == USBFS_GetEPState(OUT_EP_NUM)) {
-            bitClkFreq = bitClkFrequency;
-
-            /* Aquire received data size. */
-            readSize = USBFS_GetEPCount(OUT_EP_NUM);
-
-            /* Get current output index of DMA. */
-            currentOutIndexVDAC = getOutIndexVDAC();
-            currentOutIndex = getOutIndexI2S();
-
-            /* Trigger DMA to copy data from OUT endpoint buffer. */
-            USBFS_ReadOutEP(OUT_EP_NUM, tmpEpBuf, readSize);
+        tmpProfile = EZI2C_buf.latencyProfile;
+        if (tmpProfile >= LATENCY_PROFILES) {
+            /* Invalid request: keep the active profile, and a pending rebuild
+            * for the next pass. */
+            EZI2C_buf.latencyProfile = profile;
+        } else if ((tmpProfile != profile) || (0u != rebuildProfile)) {
+            profile = tmpProfile;
+
+            /* The TD chains are rebuilt with BitClk stopped. DMA transfers
+            * restart when half of the new ring is fulfilled. */
+            FracDiv_Stop();
+            syncDma = 0u;
+            VDAC8_L_Data = 128u;
+            VDAC8_R_Data = 128u;
+            setLatencyProfile(profile, fs);
+            rebuildProfile = 0u;
 
-            /* Wait until DMA completes copying data from OUT endpoint buffer. */
-            while (USBFS_OUT_BUFFER_FULL == USBFS_GetEPState(OUT_EP_NUM)) ;
+            DLOG(DLOG_LATENCY, profile, numOfBuffers, transferSize);
+        }
 
-            /* Enable OUT endpoint to receive data from host. */
-            USBFS_EnableOutEP(OUT_EP_NUM);
+        /* Serve history page requested through EZI2C. */
+        serveHistoryPage();
 
-            /* Check if there is a room to receive data. */
-            if (BUFFERED_DATA_SIZE>BUFFER_SIZE-TRANSFER_SIZE) {
-                flag|=USB_DROP_FLAG;
-                DP("USB_DROP");
+        /*******************************************************************************
+        * Receive data from USB and extract into audio buffers.
+        *******************************************************************************/
+#if (!AUDIO_OUT_ISR_MODE)
+        if (USBFS_OUT_BUFFER_FULL == USBFS_GetEPState(OUT_EP_NUM)) {
+            receiveOutPacket();
+        }
+#endif
+
+        /* Packets received since the last run are handled at once. */
+        rxCount = rxPacketCount;
+        if (rxCount != lastRxCount) {
+            /* Take a consistent snapshot of the receive stage status. */
+            intr = CyEnterCriticalSection();
+            rxCount = rxPacketCount;
+            rxDrop = rxDropCount;
+            currentOutIndexVDAC = rxOutIndexVDAC;
+            currentOutIndex = rxOutIndexI2S;
+            dist0 = rxDist0;
+            tmpDist = rxDist;
+            CyExitCriticalSection(intr);
+
+            if (rxDrop != lastRxDrop) {
+                lastRxDrop = rxDrop;
+                DLOG(DLOG_USB_DROP);
             } else {
-                flag&=~USB_DROP_FLAG;
-                /* Separate 2-channel data and append into each buffer. */
-                for (i = 0u; i < readSize/(AUDIO_CH*BYTES_PER_CH); i++) {
-                    soundBuffer_L[inIndex] = tmpEpBuf[BYTES_PER_CH*AUDIO_CH*i + 1]+128u;
-                    soundBuffer_R[inIndex] = tmpEpBuf[BYTES_PER_CH*AUDIO_CH*i + 3]+128u;
-                    soundBuffer_I2S[inIndex*I2S_DATA_SIZE+0] = tmpEpBuf[BYTES_PER_CH*AUDIO_CH*i +1];
-                    soundBuffer_I2S[inIndex*I2S_DATA_SIZE+1] = tmpEpBuf[BYTES_PER_CH*AUDIO_CH*i +0];
-                    soundBuffer_I2S[inIndex*I2S_DATA_SIZE+2] = tmpEpBuf[BYTES_PER_CH*AUDIO_CH*i +3];
-                    soundBuffer_I2S[inIndex*I2S_DATA_SIZE+3] = tmpEpBuf[BYTES_PER_CH*AUDIO_CH*i +2];
-                    inIndex = (inIndex+1) % BUFFER_SIZE;
+                dist = tmpDist;
+                servoUpdateAverage(&servo, dist);
+#if (SERVO_ADAPTIVE_TARGET)
+                if (syncDma) {
+                    servoTrackJitter(&servo, dist);
                 }
-                dist0 = (inIndex - outIndex*TRANSFER_SIZE + BUFFER_SIZE)%BUFFER_SIZE;
-                dist = (inIndex - currentOutIndex + BUFFER_SIZE)%BUFFER_SIZE;
-                distAverage = distAverage*(1-MovingAverageWeight) + dist*MovingAverageWeight;
+#endif
             }
-                
-            /* Start DMA transfers when half of the sound buffer is fulfilled. */
-            if (!syncDma && (dist >= sHALF_BUFFER_SIZE)) {
+
+            /* Start DMA transfers when the sound buffer is fulfilled up to the target. */
+            if (!syncDma && (dist >= servoStartLevel(&servo))) {
                 /* Disable underflow delayed start. */
                 syncDma = 1u;
 
                 /* Reset dist average. */
-                distAverage = dist;
+                servoResetAverage(&servo, dist);
 
                 /* Start BitClk Generator to start DMA transfer. */
                 FracDiv_Start();
+#if (SERVO_PI_CONTROL) && (!AUDIO_ASYNC_MODE)
+                servoTime = tickCount;
+#endif
 
+                intr = CyEnterCriticalSection();
                 flag &= ~DMA_STOP_FLAG;
+                CyExitCriticalSection(intr);
                 
-                DP("\nDMA Clock START dist=%d\n", dist);
+                DLOG(DLOG_DMA_START, dist);
             }
 
             /*******************************************************************************
             * BitClk adjustment.
             *******************************************************************************/
             if (syncDma) {
-                if (++adjustIntervalCount >= adjustInterval) {
+#if (SERVO_PI_CONTROL) && (!AUDIO_ASYNC_MODE)
+                /* PI loop on the 1ms tick, so its gains do not depend on the packets. */
+                if (TICK_ELAPSED(servoTime) >= SERVO_PI_PERIOD_MS) {
+                    PROFILE_BEGIN(PROFILE_SERVO);
+                    servoTime += SERVO_PI_PERIOD_MS;
+                    bitClkFreq = getBitClkFrequency(&bitClkSeq);
+                    if (servoControl(&servo, bitClkFreq, bitClkSeq != lastBitClkSeq)) {
+                        FracDiv_Write(servo.div, 0x7fffffffu);
+                    }
+                    lastBitClkSeq = bitClkSeq;
+                    PROFILE_END(PROFILE_SERVO);
+                }
+#else
+                adjustIntervalCount += (uint8)(rxCount - lastRxCount);
+                if (adjustIntervalCount >= adjustInterval) {
+                    PROFILE_BEGIN(PROFILE_SERVO);
                     adjustIntervalCount = 0u;
-                    if (fs > 1 && bitClkFreq > 1) {
-                        float d = bitClkFreq -fs;
-                        if (fabs(d/fs) > (1/100.0)) {
-                            /* Rapid (coarse) frequency adjustment. */
-                            divAdj += (initialDiv+divAdj)*(fs/bitClkFreq - 1.0)*0.8;
-                            DP("0");
-                        } else if (fabs(d/fs) > (1/150.0)) {
-                            /* Slower (fine) frequency adjustment. */
-                            divAdj += (initialDiv+divAdj)*(fs/bitClkFreq - 1.0)*0.4;
-                            DP("1");
-                        } else {
-                            /* Precise frequency adjustment. */
-                            divAdj += (initialDiv+divAdj)*(fs/bitClkFreq - 1.0)*0.1;
-
-                            clockAdjust = 0;
-                            /* Buffered data size based precise adjustment. */
-                            /* If buffered data size is over half and still increasing, then set the clock faster (decrease the divider). */
-                            if ( distAverage > (sHALF_BUFFER_SIZE+UpperAdjustRange)) {
-                                divAdj += adjustTic;
-                                clockAdjust = UpperAdjustRange;
-                            }
-                            /* If buffered size is under half and still decreasing, then set the clock slower (increase the divider). */
-                            if ( distAverage < (sHALF_BUFFER_SIZE+LowerAdjustRange)) {
-                                divAdj -= adjustTic;
-                                clockAdjust = LowerAdjustRange;
-                            }
-                        }
+                    bitClkFreq = getBitClkFrequency(&bitClkSeq);
+#if (AUDIO_ASYNC_MODE)
+                    /* BitClk stays at the nominal divider. Steer the host instead. */
+                    servoFeedback(&servo, bitClkFreq);
+#else
+                    if (servoAdjust(&servo, bitClkFreq, bitClkSeq != lastBitClkSeq)) {
+                        FracDiv_Write(servo.div, 0x7fffffffu);
                     }
-
-                    tmpDiv = initialDiv+divAdj;
-                    if (div != tmpDiv) {
-                        div = tmpDiv;
-                        div = (div < div_MIN) ? div_MIN : div;
-                        div = (div > div_MAX) ? div_MAX : div;
-                        FracDiv_Write(div, 0x7fffffffu);
+                    if (SERVO_BAND_COARSE == servo.band) {
+                        DLOG(DLOG_SERVO_COARSE);
+                    } else if (SERVO_BAND_FINE == servo.band) {
+                        DLOG(DLOG_SERVO_FINE);
                     }
+                    lastBitClkSeq = bitClkSeq;
+#endif
+                    PROFILE_END(PROFILE_SERVO);
                 }
+#endif
+            }
+
+            /*******************************************************************************
+            * Capture servo state into the history.
+            *******************************************************************************/
+            PROFILE_BEGIN(PROFILE_EZI2C);
+            entry = telemetryDue((uint8)(rxCount - lastRxCount));
+            if (NULL != entry) {
+                entry->bitClkFreqency = getBitClkFrequency(NULL);
+                entry->div = servo.div;
+                entry->dist = dist;
+                entry->distAverage = servo.distAverage >> SERVO_DIST_Q;
+                entry->clockAdjust = servo.clockAdjust;
+                entry->band = servo.band;
+                entry->flag = flag;
             }
 
             /*******************************************************************************
             * Update EZI2C monitoring values.
             *******************************************************************************/
             if ( (EZI2C_GetActivity() & EZI2C_STATUS_BUSY) == 0u ) {
-                EZI2C_buf.bitClkFreqency = bitClkFrequency;
-                EZI2C_buf.div = div;
+                TELEMETRY_BEGIN();
+                EZI2C_buf.numOfBuffers = numOfBuffers;
+                EZI2C_buf.latency = servoLatency(&servo);
+                EZI2C_buf.bitClkFreqency = getBitClkFrequency(NULL);
+                EZI2C_buf.div = servo.div;
                 EZI2C_buf.dist = dist0;
-                EZI2C_buf.distAvrerage = distAverage;
-                EZI2C_buf.clockAdjust = clockAdjust;
-                EZI2C_buf.inOutDiffVDAC = (inIndex - currentOutIndexVDAC + BUFFER_SIZE)%BUFFER_SIZE;
-                EZI2C_buf.inOutDiffI2S = (inIndex - currentOutIndex + BUFFER_SIZE)%BUFFER_SIZE;
+                EZI2C_buf.distAvrerage = servo.distAverage >> SERVO_DIST_Q;
+                EZI2C_buf.distTarget = servo.target;
+#if (SERVO_ADAPTIVE_TARGET)
+                EZI2C_buf.jitter = servo.jitter;
+#endif
+                EZI2C_buf.clockAdjust = servo.clockAdjust;
+                EZI2C_buf.inOutDiffVDAC = ringAhead(&soundRing, currentOutIndexVDAC);
+                EZI2C_buf.inOutDiffI2S = ringAhead(&soundRing, currentOutIndex);
                 EZI2C_buf.L = VDAC8_L_Data;
                 EZI2C_buf.R = VDAC8_R_Data;
                 EZI2C_buf.flag = flag;
+                TELEMETRY_END();
             }
+            PROFILE_END(PROFILE_EZI2C);
+
+            lastRxCount = rxCount;
         }
         
+#if (AUDIO_ASYNC_MODE)
+        /* Keep the feedback endpoint loaded with the latest value. */
+        loadFeedback(servo.feedback);
+#endif
+
+#if (AUDIO_CONCEAL)
+        if (flag & CONCEAL_FLAG) {
+            intr = CyEnterCriticalSection();
+            flag &= ~CONCEAL_FLAG;
+            CyExitCriticalSection(intr);
+            DLOG(DLOG_CONCEAL);
+        }
+#endif
         if (syncDma && (flag & DMA_STOP_FLAG)) {
-            DP("DMA_STOP");
+            DLOG(DLOG_DMA_STOP);
             syncDma = 0u;
             FracDiv_Stop();
         }
@@ -377,12 +394,17 @@ void initComponents() {
     /* Enable global interrupts. */
     CyGlobalIntEnable;
 
-    /* Start UART for debug print. */
-    DP_Start();
+    /* Start DWT cycle counter for stage profiling. */
+    initProfiler();
 
-    /* Start EZI2C for debug monitoring. */
-    EZI2C_SetBuffer1(sizeof(EZI2C_buf), 0, (void *)&EZI2C_buf);
-    EZI2C_Start();
+    /* Start UART for debug log. */
+    initDebugLog();
+
+    /* Start 1ms tick for LCD timing. */
+    initTick();
+
+    /* Start EZI2C for debug monitoring and latency profile selection. */
+    initTelemetry();
 
     /* "Stop" BitClk Generator. */
     FracDiv_Stop();
@@ -398,8 +420,10 @@ void initComponents() {
     VDAC8_R_Start();
 
     /* Start LCD display for indication. */
-    I2C_CharLCD_Start();
-    CharLCD_Start();
+    initLcd();
+#if (AUDIO_LEVEL_METER)
+    initMeter();
+#endif
 
     /* Start PGAs */
     PGA_L_Start();
@@ -419,122 +443,4 @@ void initComponents() {
     VdacDmaDone_StartEx(&VdacDmaDone);
 }
 
-/*******************************************************************************
-* Initialize (1)VdacDma_L, (2)VdacDma_R and (3)I2S_DMA.
-*******************************************************************************/
-void initDMAs() {
-    uint8 i;
-
-    /* Initialize DMA channel. */
-    VdacOutDmaCh_L = VdacDma_L_DmaInitialize(VDAC_DMA_BYTES_PER_BURST, VDAC_DMA_REQUEST_PER_BURST,
-                                             HI16(VDAC_DMA_SRC_BASE_L), HI16(VDAC_DMA_DST_BASE));
-    VdacOutDmaCh_R = VdacDma_R_DmaInitialize(VDAC_DMA_BYTES_PER_BURST, VDAC_DMA_REQUEST_PER_BURST,
-                                             HI16(VDAC_DMA_SRC_BASE_R), HI16(VDAC_DMA_DST_BASE));
-    I2SDmaCh = I2S_DMA_DmaInitialize(I2S_DMA_BYTES_PER_BURST, I2S_DMA_REQUEST_PER_BURST,
-                                     HI16(I2S_DMA_SRC_BASE), HI16(I2S_DMA_DST_BASE));
-
-    /* Allocate transfer descriptors for each buffer chunk. */
-    for (i = 0u; i < NUM_OF_BUFFERS; ++i) {
-        VdacOutDmaTd_L[i] = CyDmaTdAllocate();
-        VdacOutDmaTd_R[i] = CyDmaTdAllocate();
-        I2SDmaTd[i] = CyDmaTdAllocate();
-    }
-    
-    /* Configure DMA transfer descriptors. */
-    for (i = 0u; i < NUM_OF_BUFFERS; ++i) {
-        /* Chain current and next DMA transfer descriptors to be in row. */
-        /* Last and 1st DMA transfer descriptors to make cyclic buffer. */
-        CyDmaTdSetConfiguration(VdacOutDmaTd_L[i], TRANSFER_SIZE, VdacOutDmaTd_L[(i + 1u)%NUM_OF_BUFFERS],
-                                (TD_INC_SRC_ADR | VDAC_DMA_TD_TERMOUT_EN));
-        CyDmaTdSetConfiguration(VdacOutDmaTd_R[i], TRANSFER_SIZE, VdacOutDmaTd_R[(i + 1u)%NUM_OF_BUFFERS],
-                                (TD_INC_SRC_ADR));
-        CyDmaTdSetConfiguration(I2SDmaTd[i], I2S_TRANSFER_SIZE, I2SDmaTd[(i + 1u)%NUM_OF_BUFFERS],
-                                (TD_INC_SRC_ADR));
-
-        /* Set source and destination addresses. */
-        CyDmaTdSetAddress(VdacOutDmaTd_L[i], LO16((uint32) &soundBuffer_L[i * TRANSFER_SIZE]),
-                          LO16((uint32) VDAC8_L_Data_PTR));
-        CyDmaTdSetAddress(VdacOutDmaTd_R[i], LO16((uint32) &soundBuffer_R[i * TRANSFER_SIZE]),
-                          LO16((uint32) VDAC8_R_Data_PTR));
-        CyDmaTdSetAddress(I2SDmaTd[i], LO16((uint32) &soundBuffer_I2S[i * I2S_TRANSFER_SIZE]),
-                          LO16((uint32) I2S_TX_CH0_F0_PTR));
-    }
-
-    /* Set 1st transfer descriptor to execute. */
-    CyDmaChSetInitialTd(VdacOutDmaCh_L, VdacOutDmaTd_L[0u]);
-    CyDmaChSetInitialTd(VdacOutDmaCh_R, VdacOutDmaTd_R[0u]);
-    CyDmaChSetInitialTd(I2SDmaCh, I2SDmaTd[0u]);
-
-    /* Start DMA operation. */
-    CyDmaChEnable(VdacOutDmaCh_L, VDAC_DMA_ENABLE_PRESERVE_TD);
-    CyDmaChEnable(VdacOutDmaCh_R, VDAC_DMA_ENABLE_PRESERVE_TD);
-    CyDmaChEnable(I2SDmaCh, I2S_DMA_ENABLE_PRESERVE_TD);
-}
-
-/*******************************************************************************
-*  Get current VDAC DMA transfer point.
-*******************************************************************************/
-uint16 getOutIndexVDAC() {
-    uint8 td;
-    CyDmaChStatus(VdacOutDmaCh_L, &td, NULL);
-    uint16 count;
-    CyDmaTdGetConfiguration(td, &count, NULL, NULL);
-
-    for (uint8 i = 0u; i < NUM_OF_BUFFERS; ++i) {
-        if (td == VdacOutDmaTd_L[i]) {
-            return (i+1)*TRANSFER_SIZE-count;
-        }
-    }
-
-    return 0;
-}
-
-/*******************************************************************************
-*  Get current I2S DMA transfer point.
-*******************************************************************************/
-uint16 getOutIndexI2S() {
-    uint8 td;
-    CyDmaChStatus(I2SDmaCh, &td, NULL);
-    uint16 count;
-    CyDmaTdGetConfiguration(td, &count, NULL, NULL);
-
-    for (uint8 i = 0u; i < NUM_OF_BUFFERS; ++i) {
-        if (td == I2SDmaTd[i]) {
-            return ((i+1)*I2S_TRANSFER_SIZE-count)*TRANSFER_SIZE/I2S_TRANSFER_SIZE;
-        }
-    }
-
-    return 0;
-}
-
-/*******************************************************************************
-*  The Interrupt Service Routine for a DMA transfer completion event. The DMA is
-*  stopped when there is no data to send.
-*******************************************************************************/
-CY_ISR(VdacDmaDone) {
-    /* Move to next buffer location and adjust to be within buffer size. */
-    outIndex = (outIndex + 1) % NUM_OF_BUFFERS;
-    if (BUFFERED_DATA_SIZE<TRANSFER_SIZE) {
-        flag |= DMA_STOP_FLAG;
-    }
-}
-
-/*******************************************************************************
-*  The Interrupt Service Routine for BitClk_Counter capture event.
-*******************************************************************************/
-CY_ISR(FreqCapt) {
-    /* Measure BitClk Frequency. */
-    tmpBitClkFreq = BitClk_Counter_ReadCounter()*1000/(float)I2S_CLOCK_FACTOR;
-    BitClk_Counter_ClearFIFO();
-
-    if (tmpBitClkFreq > 0) {
-        if (bitClkCountWait > 0u) {
-            bitClkCountWait--;
-        } else {
-            bitClkFrequency = (bitClkFrequency == 0) ? tmpBitClkFreq : bitClkFrequency*0.8 + tmpBitClkFreq*0.2;
-            //bitClkFrequency = tmpBitClkFreq;
-        }
-    }
-}
-
 /* [] END OF FILE */
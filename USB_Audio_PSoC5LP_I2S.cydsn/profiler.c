@@ -0,0 +1,85 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Cycle profiling of the pipeline stages.
+*
+*******************************************************************************/
+#include "profiler.h"
+
+#if (PROFILING)
+/* Running statistics of each stage. */
+typedef struct {
+    uint32 min;
+    uint32 max;
+    uint64 sum;
+    uint32 count;
+} PROFILE_ACC;
+
+static PROFILE_ACC profileAcc[PROFILE_STAGES];
+
+/*******************************************************************************
+*  Clear the statistics of all stages.
+*******************************************************************************/
+static void profileClear() {
+    uint8 i;
+
+    for (i = 0u; i < PROFILE_STAGES; i++) {
+        profileAcc[i].min = 0xFFFFFFFFu;
+        profileAcc[i].max = 0u;
+        profileAcc[i].sum = 0u;
+        profileAcc[i].count = 0u;
+    }
+}
+
+/*******************************************************************************
+*  Start the DWT cycle counter and clear the statistics.
+*******************************************************************************/
+void initProfiler() {
+    startCycleCounter();
+    profileClear();
+}
+
+/*******************************************************************************
+*  Record one run of stage that took cycles.
+*******************************************************************************/
+void profileRecord(uint8 stage, uint32 cycles) {
+    PROFILE_ACC *p = &profileAcc[stage];
+
+    p->min = (cycles < p->min) ? cycles : p->min;
+    p->max = (cycles > p->max) ? cycles : p->max;
+    p->sum += cycles;
+    p->count++;
+}
+
+/*******************************************************************************
+*  Copy the statistics of all stages into stat[PROFILE_STAGES] and restart
+*  them. min is 0 for a stage that has not run.
+*******************************************************************************/
+void profileExport(PROFILE_STAT *stat) {
+    PROFILE_ACC acc[PROFILE_STAGES];
+    uint8 i;
+
+    /* The ISR stages are recorded concurrently. */
+    uint8 intr = CyEnterCriticalSection();
+    for (i = 0u; i < PROFILE_STAGES; i++) {
+        acc[i] = profileAcc[i];
+    }
+    profileClear();
+    CyExitCriticalSection(intr);
+
+    for (i = 0u; i < PROFILE_STAGES; i++) {
+        stat[i].count = acc[i].count;
+        if (0u == acc[i].count) {
+            stat[i].min = 0u;
+            stat[i].avg = 0u;
+            stat[i].max = 0u;
+        } else {
+            stat[i].min = acc[i].min;
+            stat[i].avg = (uint32)(acc[i].sum / acc[i].count);
+            stat[i].max = acc[i].max;
+        }
+    }
+}
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,83 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Cycle profiling of the pipeline stages with the Cortex-M3 DWT cycle counter.
+*
+* PROFILE_BEGIN(stage)/PROFILE_END(stage) around a stage record its cycles
+* into min/avg/max statistics. A stage may contain others, e.g. the servo
+* block includes its debug log records. Each stage is recorded from one
+* context only, the main loop or its ISR. The statistics are read over EZI2C
+* as the TELEMETRY_PROFILE_PAGE history page (see telemetry.h), which also
+* restarts them, so they cover the time since the previous read.
+*
+* A host build defines PROFILER_HOST_CYCLES as the name of a function
+* returning a 32-bit cycle count, so the same markers run in simulation.
+*
+*******************************************************************************/
+#if !defined(PROFILER_H)
+#define PROFILER_H
+
+#include <project.h>
+
+/*
+ * Stage profiling.
+ *  0: Markers compile to nothing.
+ *  1: Markers record cycles.
+ */
+#if !defined(PROFILING)
+#define PROFILING                   (0u)
+#endif
+
+/* Profiled stages. */
+#define PROFILE_EP_READ             (0u)    /* Endpoint read and wait. */
+#define PROFILE_CONVERT             (1u)    /* Packet deinterleave into the sound buffers. */
+#define PROFILE_SERVO               (2u)    /* BitClk adjustment block. */
+#define PROFILE_EZI2C               (3u)    /* EZI2C snapshot and history update. */
+#define PROFILE_VDAC_ISR            (4u)    /* VdacDmaDone. */
+#define PROFILE_FREQ_ISR            (5u)    /* FreqCapt. */
+#define PROFILE_LCD                 (6u)    /* lcdService(). */
+#define PROFILE_LOG                 (7u)    /* Debug log record writes. */
+#define PROFILE_STAGES              (8u)
+
+/* Statistics of a stage as exported [cycles]. */
+typedef struct {
+    uint32 min;
+    uint32 avg;
+    uint32 max;
+    uint32 count;
+} PROFILE_STAT;
+
+/* Cycle counter, also the debug log timestamp. */
+#if defined(PROFILER_HOST_CYCLES)
+uint32 PROFILER_HOST_CYCLES(void);
+#define PROFILER_CYCLES()           PROFILER_HOST_CYCLES()
+#else
+#define PROFILER_CYCLES()           (DWT->CYCCNT)
+#endif
+
+/*******************************************************************************
+*  Start the DWT cycle counter. It is left running if already started.
+*******************************************************************************/
+static CY_INLINE void startCycleCounter(void) {
+#if !defined(PROFILER_HOST_CYCLES)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+#if (PROFILING)
+#define PROFILE_BEGIN(stage)        uint32 profileStart_##stage = PROFILER_CYCLES()
+#define PROFILE_END(stage)          profileRecord((stage), PROFILER_CYCLES() - profileStart_##stage)
+
+void initProfiler(void);
+void profileRecord(uint8 stage, uint32 cycles);
+void profileExport(PROFILE_STAT *stat);
+#else
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END(stage)
+#define initProfiler()
+#endif
+
+#endif /* PROFILER_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,72 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Monitoring over EZI2C: snapshot buffer and servo state history.
+*
+*******************************************************************************/
+#include "telemetry.h"
+#include "profiler.h"
+#include <string.h>
+
+/* EZI2C buffer watched by external device (PC). */
+struct _EZI2C_buf EZI2C_buf;
+
+/* Servo state history. */
+static TELEMETRY_ENTRY history[TELEMETRY_HISTORY];
+static uint16 historyCount = 0u;
+static uint8 intervalCount = 0u;
+
+/*******************************************************************************
+*  Expose EZI2C_buf to the PC and start EZI2C.
+*******************************************************************************/
+void initTelemetry() {
+    EZI2C_buf.historyPage = TELEMETRY_NO_PAGE;
+    EZI2C_buf.pageReady = TELEMETRY_NO_PAGE;
+    EZI2C_buf.historyInterval = TELEMETRY_INTERVAL;
+
+    EZI2C_SetBuffer1(sizeof(EZI2C_buf), TELEMETRY_RW_SIZE, (void *)&EZI2C_buf);
+    EZI2C_Start();
+}
+
+/*******************************************************************************
+*  Count packets received. Returns the history entry to fill once every
+*  TELEMETRY_INTERVAL packets, otherwise NULL.
+*******************************************************************************/
+TELEMETRY_ENTRY *telemetryDue(uint8 packets) {
+    intervalCount += packets;
+    if (intervalCount < TELEMETRY_INTERVAL) {
+        return NULL;
+    }
+    intervalCount = 0u;
+
+    return &history[historyCount++ & (TELEMETRY_HISTORY - 1u)];
+}
+
+/*******************************************************************************
+*  Copy the history page, or the profiling statistics, requested by the PC
+*  into the page window.
+*******************************************************************************/
+void serveHistoryPage() {
+    uint8 page = EZI2C_buf.historyPage;
+
+    if (page < TELEMETRY_PAGES) {
+        EZI2C_buf.pageReady = TELEMETRY_NO_PAGE;
+        __DMB();
+        EZI2C_buf.historyCount = historyCount;
+        memcpy(EZI2C_buf.page, &history[page*TELEMETRY_PAGE_ENTRIES], sizeof(EZI2C_buf.page));
+#if (PROFILING)
+    } else if (TELEMETRY_PROFILE_PAGE == page) {
+        EZI2C_buf.pageReady = TELEMETRY_NO_PAGE;
+        __DMB();
+        profileExport((PROFILE_STAT *)EZI2C_buf.page);
+#endif
+    } else {
+        return;
+    }
+
+    __DMB();
+    EZI2C_buf.pageReady = page;
+    EZI2C_buf.historyPage = TELEMETRY_NO_PAGE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,102 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* Monitoring over EZI2C: a tear-free snapshot of the latest values and a RAM
+* history of servo state.
+*
+* EZI2C reads the buffer a byte at a time from its ISR, so the main loop can
+* change it in the middle of a read. The snapshot is therefore written as a
+* seqlock for a reader that goes from low to high addresses: seqStart, at the
+* end, is incremented before the values are written and seqDone, at the front,
+* is set to it after. A read whose seqDone and seqStart differ overlapped an
+* update and is retried. The main loop does not update while EZI2C is busy,
+* so the 8-bit sequence cannot wrap within a read.
+*
+* The history holds TELEMETRY_HISTORY entries captured every
+* TELEMETRY_INTERVAL packets. The PC pages through it:
+*  1. Write a page number (0 to TELEMETRY_PAGES-1) to historyPage,
+*     e.g. "w 10 01 03 p".
+*  2. Read historyPage until it is back to TELEMETRY_NO_PAGE. The page window
+*     then holds page pageReady, i.e. the entries from
+*     pageReady*TELEMETRY_PAGE_ENTRIES onwards, and historyCount the number of
+*     entries captured (wraps) at the copy. The newest entry is
+*     (historyCount-1)%TELEMETRY_HISTORY. A request written while the previous
+*     one is served may be lost, so retry when pageReady does not match.
+* The window does not change until another page is requested.
+* With PROFILING set in profiler.h, page TELEMETRY_PROFILE_PAGE holds a
+* PROFILE_STAT for each stage instead.
+*
+*******************************************************************************/
+#if !defined(TELEMETRY_H)
+#define TELEMETRY_H
+
+#include <project.h>
+#include <stddef.h>
+
+/* History ring. TELEMETRY_HISTORY is a power of two and a multiple of
+ * TELEMETRY_PAGE_ENTRIES. */
+#define TELEMETRY_HISTORY           (128u)
+#define TELEMETRY_INTERVAL          (8u)
+#define TELEMETRY_PAGE_ENTRIES      (8u)
+#define TELEMETRY_PAGES             (TELEMETRY_HISTORY/TELEMETRY_PAGE_ENTRIES)
+#define TELEMETRY_PROFILE_PAGE      (0x80u)
+#define TELEMETRY_NO_PAGE           (0xFFu)
+
+/* Servo state captured into the history. */
+typedef struct {
+    uint32 bitClkFreqency;  /* Q24.8 Hz */
+    uint32 div;
+    uint16 dist;            /* Buffered data size fed to the servo. */
+    uint16 distAverage;
+    int16 clockAdjust;
+    uint8 band;             /* SERVO_BAND_xxx */
+    uint8 flag;
+} TELEMETRY_ENTRY;
+
+/* EZI2C buffer watched by external device (PC). Only latencyProfile and
+ * historyPage are writable, e.g. "w 10 00 02 p" selects LATENCY_PROFILE_LOW. */
+struct _EZI2C_buf {
+    uint8 latencyProfile;   /* LATENCY_PROFILE_xxx */
+    uint8 historyPage;      /* Requested history page. */
+
+    /* Snapshot, consistent when seqDone == seqStart. */
+    uint8 seqDone;
+    uint8 numOfBuffers;
+    uint16 latency;         /* us */
+    uint32 bitClkFreqency;  /* Q24.8 Hz */
+    uint32 div;
+    uint16 dist;
+    uint16 distAvrerage;
+    uint16 distTarget;
+    uint16 jitter;
+    int16 clockAdjust;
+    int16 inOutDiffVDAC;
+    int16 inOutDiffI2S;
+    uint8 L;
+    uint8 R;
+    uint8 flag;
+    uint8 seqStart;
+
+    /* History page window. */
+    uint8 pageReady;        /* Page copied into the window. */
+    uint8 historyInterval;  /* Packets per entry. */
+    uint16 historyCount;    /* Entries captured at the copy. */
+    TELEMETRY_ENTRY page[TELEMETRY_PAGE_ENTRIES];   /* Or PROFILE_STAT[PROFILE_STAGES]. */
+};
+extern struct _EZI2C_buf EZI2C_buf;
+
+#define TELEMETRY_RW_SIZE           (offsetof(struct _EZI2C_buf, seqDone))
+
+/* Open and close a snapshot update. The DMBs keep the compiler from moving
+ * the value stores across the sequence stores. */
+#define TELEMETRY_BEGIN()           {EZI2C_buf.seqStart++; __DMB();}
+#define TELEMETRY_END()             {__DMB(); EZI2C_buf.seqDone = EZI2C_buf.seqStart;}
+
+/* Function prototype deffinitions. */
+void initTelemetry(void);
+TELEMETRY_ENTRY *telemetryDue(uint8 packets);
+void serveHistoryPage(void);
+
+#endif /* TELEMETRY_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,26 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* 1ms system tick from the Cortex-M3 SysTick timer.
+*
+*******************************************************************************/
+#include "tick.h"
+
+volatile uint32 tickCount = 0u;
+
+/*******************************************************************************
+*  SysTick callback.
+*******************************************************************************/
+static void tickIsr(void) {
+    tickCount++;
+}
+
+/*******************************************************************************
+*  Start SysTick at 1ms (CySysTickStart() default) and count it.
+*******************************************************************************/
+void initTick() {
+    CySysTickStart();
+    (void)CySysTickSetCallback(0u, &tickIsr);
+}
+
+/* [] END OF FILE */
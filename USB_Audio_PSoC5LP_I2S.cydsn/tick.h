@@ -0,0 +1,23 @@
+/*******************************************************************************
+* CY8CKIT-059(PSoC 5LP) USB Audio with Internal DAC and I2S Dual Out
+*
+* 1ms system tick from the Cortex-M3 SysTick timer.
+*
+*******************************************************************************/
+#if !defined(TICK_H)
+#define TICK_H
+
+#include <project.h>
+
+/* Milliseconds since initTick(), wraps after 49 days. */
+extern volatile uint32 tickCount;
+
+/* Milliseconds passed since tick value since. */
+#define TICK_ELAPSED(since)         ((uint32)(tickCount - (since)))
+
+/* Function prototype deffinitions. */
+void initTick(void);
+
+#endif /* TICK_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,431 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Audio path simulator. Replays a stereo WAV file through audio_path.c as
+* built for the target, against the mock USBFS/DMA/VDAC/I2S of mock/:
+*  - the WAV data is sent as 1ms OUT packets of the rate, e.g. nine of 44 and
+*    one of 45 frames at 44.1kHz, in the alternate setting of its bit depth;
+*  - the main loop's receive stage and DMA start are modelled, and the DMAs
+*    run at exactly fs once half of the ring is filled, raising VdacDmaDone at
+*    each chunk end. With AUDIO_OUT_ISR_MODE set, the USBFS ISR callbacks run
+*    the receive stage as the packet is taken instead;
+*  - the bytes the VdacDma_L, VdacDma_R and I2S_DMA channels send are written
+*    to the output files.
+* Silence follows the WAV data until as many frames as it holds have been
+* sent, and the output is cut there, so the streams do not depend on the ring
+* geometry. A clean stream is the WAV data converted frame by frame; -c checks
+* the streams against that reference model.
+*
+* Usage: audio_sim [-p profile] [-r repeat] [-s stall] [-c] in.wav vdac_l vdac_r i2s
+* An output file of "-" is not written. -r replays the WAV data repeat times
+* for throughput measurement. -s stalls the main loop for stall us every
+* SIM_STALL_PERIOD packets, from the arrival of the packet on, as a blocking
+* print does; packets arriving while the endpoint is still full are missed.
+* The packet service latency is the time from the arrival of a packet until
+* the receive stage has stored it: the main loop stall waited for, plus the
+* receive stage run time measured on the host. A stream the build has no
+* alternate setting for exits with SIM_SKIPPED.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "audio_path.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* DMA channels of audio_path.c. */
+extern uint8 VdacOutDmaCh_L;
+extern uint8 VdacOutDmaCh_R;
+extern uint8 I2SDmaCh;
+
+#define SIM_OUTPUTS                 (3u)
+#define SIM_OUT_L                   (0u)
+#define SIM_OUT_R                   (1u)
+#define SIM_OUT_I2S                 (2u)
+#define SIM_SKIPPED                 (77)
+#define SIM_STALL_PERIOD            (100u)
+
+typedef struct {
+    uint8 *data;
+    size_t size;
+    size_t capacity;
+} SIM_STREAM;
+
+typedef struct {
+    uint32 fs;
+    uint16 bits;
+    uint16 frameBytes;
+    uint32 frames;
+    uint8 *data;
+} SIM_WAV;
+
+static SIM_STREAM simOut[SIM_OUTPUTS];
+static uint8 simChannel[SIM_OUTPUTS];
+
+/*******************************************************************************
+*  DMA sink: append the byte to the stream of its channel.
+*******************************************************************************/
+static void simSink(uint8 ch, uint8 data) {
+    SIM_STREAM *s;
+    uint8 i;
+
+    for (i = 0u; (i < SIM_OUTPUTS) && (simChannel[i] != ch); i++) {
+    }
+    if (SIM_OUTPUTS == i) {
+        return;
+    }
+    s = &simOut[i];
+    if (s->size == s->capacity) {
+        s->capacity = (0u == s->capacity) ? 65536u : 2u*s->capacity;
+        s->data = realloc(s->data, s->capacity);
+        if (NULL == s->data) {
+            fprintf(stderr, "audio_sim: out of memory\n");
+            exit(2);
+        }
+    }
+    s->data[s->size++] = data;
+}
+
+static uint32 le16(const uint8 *p) {
+    return (uint32)p[0] | ((uint32)p[1] << 8);
+}
+
+static uint32 le32(const uint8 *p) {
+    return le16(p) | (le16(p + 2) << 16);
+}
+
+/*******************************************************************************
+*  Read a 2-channel PCM WAV file of 16, 24 or 32 bits. Exits on error.
+*******************************************************************************/
+static void readWav(const char *path, SIM_WAV *w) {
+    FILE *f = fopen(path, "rb");
+    uint8 *file;
+    long size;
+    long pos = 12;
+    uint32 len;
+    uint16 format = 0u;
+
+    if (NULL == f) {
+        perror(path);
+        exit(2);
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    file = malloc((size_t)size);
+    if ((NULL == file) || (fread(file, 1u, (size_t)size, f) != (size_t)size) ||
+        (size < 12) || (0 != memcmp(file, "RIFF", 4u)) || (0 != memcmp(file + 8, "WAVE", 4u))) {
+        fprintf(stderr, "%s: not a WAV file\n", path);
+        exit(2);
+    }
+    fclose(f);
+
+    memset(w, 0, sizeof(*w));
+    while (pos + 8 <= size) {
+        len = le32(file + pos + 4);
+        if ((0 == memcmp(file + pos, "fmt ", 4u)) && (len >= 16u)) {
+            format = (uint16)le16(file + pos + 8);
+            if (AUDIO_CH != le16(file + pos + 10)) {
+                format = 0u;
+            }
+            w->fs = le32(file + pos + 12);
+            w->frameBytes = (uint16)le16(file + pos + 20);
+            w->bits = (uint16)le16(file + pos + 22);
+        } else if (0 == memcmp(file + pos, "data", 4u)) {
+            len = (pos + 8 + (long)len > size) ? (uint32)(size - pos - 8) : len;
+            w->data = file + pos + 8;
+            w->frames = (0u == w->frameBytes) ? 0u : len/w->frameBytes;
+        }
+        pos += 8 + (long)((len + 1u) & ~1u);
+    }
+    if (((1u != format) && (0xFFFEu != format)) || (NULL == w->data) ||
+        ((16u != w->bits) && (24u != w->bits) && (32u != w->bits)) || (w->frameBytes != w->bits/8u*AUDIO_CH)) {
+        fprintf(stderr, "%s: needs 2-channel 16/24/32-bit PCM\n", path);
+        exit(2);
+    }
+}
+
+/*******************************************************************************
+*  Sample k (0: left, 1: right) of frame i as a left-aligned 32-bit word.
+*******************************************************************************/
+static uint32 wavSample(const SIM_WAV *w, uint32 i, uint8 k) {
+    const uint8 *p = w->data + (size_t)i*w->frameBytes + k*(w->bits/8u);
+
+    switch (w->bits) {
+    case 16u:
+        return le16(p) << 16;
+    case 24u:
+        return ((uint32)p[0] << 8) | ((uint32)p[1] << 16) | ((uint32)p[2] << 24);
+    default:
+        return le32(p);
+    }
+}
+
+/*******************************************************************************
+*  Check the streams against the reference model: the VDAC bytes are the upper
+*  sample bytes in offset binary, the I2S frames the upper I2S_DATA_BITS of
+*  each sample MSB first. Returns the number of mismatching frames.
+*******************************************************************************/
+static uint32 checkReference(const SIM_WAV *w, uint32 frames) {
+    uint32 errors = 0u;
+    uint32 i;
+    uint32 s;
+    uint8 k;
+    uint8 b;
+    uint8 bad;
+
+    for (i = 0u; i < frames; i++) {
+        bad = 0u;
+        for (k = 0u; k < AUDIO_CH; k++) {
+            s = wavSample(w, i % w->frames, k);
+#if (USE_VDAC_OUTPUT) && (!VDAC_NOISE_SHAPING)
+            bad |= (simOut[k].data[i] != ((uint8)(s >> 24) ^ 0x80u));
+#endif
+#if (USE_I2S_OUTPUT)
+            for (b = 0u; b < I2S_DATA_BITS/8u; b++) {
+                bad |= (simOut[SIM_OUT_I2S].data[(size_t)i*I2S_DATA_SIZE + k*(I2S_DATA_BITS/8u) + b] !=
+                        (uint8)(s >> (24u - 8u*b)));
+            }
+#else
+            (void)b;
+#endif
+        }
+        if ((0u != bad) && (errors++ < 8u)) {
+            fprintf(stderr, "reference mismatch at frame %lu\n", (unsigned long)i);
+        }
+    }
+
+    return errors;
+}
+
+static void writeStream(const char *path, const SIM_STREAM *s, size_t size) {
+    FILE *f;
+
+    if (0 == strcmp(path, "-")) {
+        return;
+    }
+    f = fopen(path, "wb");
+    if ((NULL == f) || (fwrite(s->data, 1u, size, f) != size) || (0 != fclose(f))) {
+        perror(path);
+        exit(2);
+    }
+}
+
+static double seconds(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec*1e-9;
+}
+
+int main(int argc, char **argv) {
+    static uint8 packet[USB_BUF_SIZE];
+    SIM_WAV wav;
+    uint8 profile = LATENCY_PROFILE_DEEP;
+    uint32 repeat = 1u;
+    uint8 check = 0u;
+    uint8 alt;
+    uint32 total;
+    uint32 sent = 0u;
+    uint32 played = 0u;
+    uint32 inAcc = 0u;
+    uint32 outAcc = 0u;
+    uint32 packets = 0u;
+    uint32 underruns = 0u;
+    uint32 drops = 0u;
+    uint32 missed = 0u;
+    uint32 stall = 0u;
+    uint32 ms;
+    uint32 n;
+    uint32 i;
+    uint8 term;
+    uint8 running = 0u;
+    uint8 dropped;
+    double t0;
+    double t;
+    double rxTime = 0.0;
+    double simTime;
+#if (!AUDIO_OUT_ISR_MODE)
+    double busyUntil = 0.0;     /* End of the main loop stall [us]. */
+    double arrival = 0.0;       /* Of the packet in the endpoint [us]. */
+    double wait;
+#endif
+    double worstWait = 0.0;
+    double worstLatency = 0.0;
+    int opt = 1;
+
+    for (; (opt < argc) && ('-' == argv[opt][0]) && ('\0' != argv[opt][1]); opt++) {
+        if ((0 == strcmp(argv[opt], "-p")) && (opt + 1 < argc)) {
+            profile = (uint8)atoi(argv[++opt]);
+        } else if ((0 == strcmp(argv[opt], "-r")) && (opt + 1 < argc)) {
+            repeat = (uint32)atoi(argv[++opt]);
+        } else if ((0 == strcmp(argv[opt], "-s")) && (opt + 1 < argc)) {
+            stall = (uint32)atoi(argv[++opt]);
+        } else if (0 == strcmp(argv[opt], "-c")) {
+            check = 1u;
+        } else {
+            break;
+        }
+    }
+    if ((argc - opt != 4) || (0u == repeat)) {
+        fprintf(stderr, "usage: audio_sim [-p profile] [-r repeat] [-s stall] [-c] in.wav vdac_l vdac_r i2s\n");
+        return 2;
+    }
+
+    readWav(argv[opt], &wav);
+    if ((!AUDIO_WIDE_FORMATS) && (wav.bits > 16u)) {
+        printf("%s: skipped, 24/32-bit streams need AUDIO_WIDE_FORMATS\n", argv[opt]);
+        return SIM_SKIPPED;
+    }
+    if ((wav.fs > 96000u) && (wav.bits > 16u)) {
+        fprintf(stderr, "%s: 24/32-bit streams go up to 96kHz\n", argv[opt]);
+        return 2;
+    }
+    if ((!AUDIO_HIGH_RATES) && (wav.fs > 96000u)) {
+        printf("%s: skipped, %lu Hz streams need AUDIO_HIGH_RATES\n", argv[opt], (unsigned long)wav.fs);
+        return SIM_SKIPPED;
+    }
+    if ((wav.fs + 999u)/1000u > ((16u == wav.bits) ? MAX_FRAMES_16BIT : MAX_FRAMES_32BIT)) {
+        fprintf(stderr, "%s: %lu Hz packets do not fit USB_BUF_SIZE\n", argv[opt], (unsigned long)wav.fs);
+        return 2;
+    }
+    alt = (16u == wav.bits) ? ALT_SETTING_16BIT : ((24u == wav.bits) ? ALT_SETTING_24BIT : ALT_SETTING_32BIT);
+    total = wav.frames*repeat;
+
+    /* Start up as main() does, with the stream's rate and format. */
+    initDMAs();
+    simChannel[SIM_OUT_L] = VdacOutDmaCh_L;
+    simChannel[SIM_OUT_R] = (USE_VDAC_OUTPUT) ? VdacOutDmaCh_R : 0xFFu;
+    simChannel[SIM_OUT_I2S] = (USE_I2S_OUTPUT) ? I2SDmaCh : 0xFFu;
+    for (i = 0u; i < SIM_OUTPUTS; i++) {
+        if (0xFFu != simChannel[i]) {
+            mockDmaSetSink(simChannel[i], &simSink);
+        }
+    }
+    setAudioFormat(alt);
+    setLatencyProfile(profile, wav.fs);
+#if (VDAC_NOISE_SHAPING)
+    setVdacShaper(wav.fs);
+#endif
+    enableOutPacket();
+
+    t0 = seconds();
+    for (ms = 0u; played < total; ms++) {
+        /* One USB frame: the packet of this ms, silence after the data. */
+        inAcc += wav.fs;
+        n = inAcc/1000u;
+        inAcc %= 1000u;
+        for (i = 0u; i < n; i++, sent++) {
+            if (sent < total) {
+                memcpy(&packet[i*wav.frameBytes], wav.data + (size_t)(sent % wav.frames)*wav.frameBytes,
+                       wav.frameBytes);
+            } else {
+                memset(&packet[i*wav.frameBytes], 0, wav.frameBytes);
+            }
+        }
+        t = seconds();
+        dropped = rxDropCount;
+        if (0u == mockUsbReceive(OUT_EP_NUM, packet, (uint16)(n*wav.frameBytes))) {
+            if (0u == stall) {
+                fprintf(stderr, "audio_sim: OUT endpoint not armed at packet %lu\n", (unsigned long)packets);
+                return 1;
+            }
+            missed++;
+        } else {
+            packets++;
+#if (AUDIO_OUT_ISR_MODE)
+            /* The USBFS ISRs have run the receive stage. */
+            t = seconds() - t;
+            rxTime += t;
+            drops += (uint8)(rxDropCount - dropped);
+            worstLatency = (t*1e6 > worstLatency) ? t*1e6 : worstLatency;
+#else
+            arrival = ms*1000.0;
+#endif
+        }
+
+        /* Main loop: a stall from this packet on, the receive stage once it
+         * is over within this ms, and DMA start at half of the ring. */
+#if (!AUDIO_OUT_ISR_MODE)
+        if ((0u != stall) && (0u == ms % SIM_STALL_PERIOD)) {
+            busyUntil = ms*1000.0 + stall;
+        }
+        if ((busyUntil < (ms + 1u)*1000.0) && (USBFS_OUT_BUFFER_FULL == USBFS_GetEPState(OUT_EP_NUM))) {
+            wait = (busyUntil > arrival) ? busyUntil - arrival : 0.0;
+            dropped = rxDropCount;
+            t = seconds();
+            receiveOutPacket();
+            t = seconds() - t;
+            rxTime += t;
+            drops += (uint8)(rxDropCount - dropped);
+            worstWait = (wait > worstWait) ? wait : worstWait;
+            worstLatency = (wait + t*1e6 > worstLatency) ? wait + t*1e6 : worstLatency;
+        }
+#endif
+        if ((0u == running) && ((int16)rxDist >= sHALF_BUFFER_SIZE)) {
+            running = 1u;
+        }
+
+        /* DMAs at fs for the rest of the ms. */
+        outAcc += wav.fs;
+        n = outAcc/1000u;
+        outAcc %= 1000u;
+        for (i = 0u; (0u != running) && (i < n); i++) {
+            term = mockDmaRequest(VdacOutDmaCh_L);
+#if (USE_VDAC_OUTPUT)
+            (void)mockDmaRequest(VdacOutDmaCh_R);
+#endif
+#if (USE_I2S_OUTPUT)
+            {
+                uint8 k;
+
+                for (k = 0u; k < I2S_DATA_SIZE; k++) {
+                    (void)mockDmaRequest(I2SDmaCh);
+                }
+            }
+#endif
+            played++;
+            if (0u != term) {
+                VdacDmaDone();
+            }
+#if (AUDIO_CONCEAL)
+            if (0u != (flag & CONCEAL_FLAG)) {
+                flag &= ~CONCEAL_FLAG;
+                underruns++;
+            }
+#endif
+            if (0u != (flag & DMA_STOP_FLAG)) {
+                flag &= ~DMA_STOP_FLAG;
+                running = 0u;
+                underruns++;
+            }
+        }
+    }
+    simTime = seconds() - t0;
+
+    writeStream(argv[opt + 1], &simOut[SIM_OUT_L], (USE_VDAC_OUTPUT) ? total : 0u);
+    writeStream(argv[opt + 2], &simOut[SIM_OUT_R], (USE_VDAC_OUTPUT) ? total : 0u);
+    writeStream(argv[opt + 3], &simOut[SIM_OUT_I2S], (USE_I2S_OUTPUT) ? (size_t)total*I2S_DATA_SIZE : 0u);
+
+    printf("%s: %lu Hz %u-bit profile %u (%u x %u frames), %lu frames in %lu packets, "
+           "%lu drops, %lu under-runs\n",
+           argv[opt], (unsigned long)wav.fs, wav.bits, profile, numOfBuffers, transferSize,
+           (unsigned long)total, (unsigned long)packets, (unsigned long)drops, (unsigned long)underruns);
+    printf("  receive stage %.1f ns/frame, %.0f ns/packet, %.0fx real time; whole simulation %.1f ns/frame\n",
+           rxTime*1e9/total, rxTime*1e9/packets, (double)total/wav.fs/rxTime, simTime*1e9/total);
+    printf("  packet service latency worst %.1f us, %.0f us of it waiting for the main loop; %lu packets missed\n",
+           worstLatency, worstWait, (unsigned long)missed);
+
+    if (0u != check) {
+        i = checkReference(&wav, total);
+        printf("  reference model: %s (%lu frames differ)\n", (0u == i) ? "OK" : "FAILED", (unsigned long)i);
+        if ((0u != i) || (0u != drops) || (0u != underruns) || (0u != missed)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* [] END OF FILE */
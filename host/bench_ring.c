@@ -0,0 +1,119 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Ring index benchmark. Runs the sound buffer bookkeeping of the receive
+* stage and VdacDmaDone, 1ms packets in and whole chunks out, with the
+* AUDIO_RING of audio_ring.h and with the modulo indices it replaced: a frame
+* index wrapped with % bufferSize on every frame, a chunk index wrapped with
+* % numOfBuffers, and the fill level of both modulo bufferSize. The ring
+* geometry is read at run time, as the latency profile sets it. Each frame
+* stores a word, so both loops do the same buffer work.
+*
+* Usage: bench_ring [packets]
+* The ratio holds for the host only: its divide costs tens of cycles, the
+* Cortex-M3 UDIV 2-12. It has to be measured again on the target.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "audio_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_PACKETS       (2000000u)
+#define BENCH_RING_MAX      (1024u)
+
+static uint32 buf[BENCH_RING_MAX];
+
+/* Ring geometry, set at run time. */
+static uint16 transferSize;
+static uint16 numOfBuffers;
+static uint16 bufferSize;
+
+static double seconds(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec*1e-9;
+}
+
+/* AUDIO_RING: free running counts, masked positions. */
+static __attribute__((noinline)) uint32 runRing(uint32 packets, uint16 frames) {
+    static AUDIO_RING ring;
+    uint32 sum = 0u;
+    uint16 head;
+    uint16 idx;
+    uint16 i;
+
+    ringInit(&ring, bufferSize);
+    while (packets-- > 0u) {
+        if (frames <= ringSpace(&ring)) {
+            head = ringHeadIndex(&ring);
+            for (i = 0u; i < frames; i++) {
+                buf[(head + i) & ring.mask] = packets;
+            }
+            ringPublish(&ring, frames);
+        }
+        while (ringFill(&ring) >= transferSize) {
+            idx = ringTailIndex(&ring);
+            sum += buf[idx];
+            ringRelease(&ring, transferSize);
+        }
+    }
+    return sum;
+}
+
+/* The modulo indices: inIndex in frames, outIndex in chunks. */
+static __attribute__((noinline)) uint32 runModulo(uint32 packets, uint16 frames) {
+    static volatile uint16 inIndex;
+    static volatile uint16 outIndex;
+    uint32 sum = 0u;
+    uint16 i;
+
+    inIndex = 0u;
+    outIndex = 0u;
+    while (packets-- > 0u) {
+        if ((bufferSize + inIndex - outIndex*transferSize) % bufferSize <= bufferSize - transferSize - frames) {
+            for (i = 0u; i < frames; i++) {
+                buf[inIndex] = packets;
+                inIndex = (inIndex + 1u) % bufferSize;
+            }
+        }
+        while ((bufferSize + inIndex - outIndex*transferSize) % bufferSize >= transferSize) {
+            sum += buf[outIndex*transferSize];
+            outIndex = (outIndex + 1u) % numOfBuffers;
+        }
+    }
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    /* DEEP, MEDIUM and LOW at 48kHz: chunks, frames per chunk. */
+    static const uint16 geometry[][2] = {{8u, 128u}, {8u, 64u}, {4u, 64u}};
+    uint32 packets = (argc > 1) ? (uint32)atoi(argv[1]) : BENCH_PACKETS;
+    uint32 sum = 0u;
+    double t0;
+    double ring;
+    double modulo;
+    uint8 g;
+
+    for (g = 0u; g < sizeof(geometry)/sizeof(geometry[0]); g++) {
+        numOfBuffers = geometry[g][0];
+        transferSize = geometry[g][1];
+        bufferSize = numOfBuffers*transferSize;
+
+        t0 = seconds();
+        sum += runRing(packets, 48u);
+        ring = seconds() - t0;
+        t0 = seconds();
+        sum += runModulo(packets, 48u);
+        modulo = seconds() - t0;
+
+        printf("ring %u x %u frames: AUDIO_RING %.2f ns/frame, modulo indices %.2f ns/frame, %.2fx\n",
+               numOfBuffers, transferSize, ring*1e9/(packets*48.0), modulo*1e9/(packets*48.0), modulo/ring);
+    }
+
+    return (0u == sum) ? 1 : 0;
+}
+
+/* [] END OF FILE */
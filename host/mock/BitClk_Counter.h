@@ -0,0 +1,21 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the BitClk_Counter component. ReadCounter returns mockBitClkCount,
+* the BitClk ticks the host clock model counted in the last SOF period.
+*
+*******************************************************************************/
+#if !defined(CY_COUNTER_BitClk_Counter_H)
+#define CY_COUNTER_BitClk_Counter_H
+
+#include "cytypes.h"
+
+void BitClk_Counter_Start(void);
+void BitClk_Counter_Stop(void);
+uint32 BitClk_Counter_ReadCounter(void);
+uint32 BitClk_Counter_ReadCapture(void);
+void BitClk_Counter_ClearFIFO(void);
+
+#endif /* CY_COUNTER_BitClk_Counter_H */
+
+/* [] END OF FILE */
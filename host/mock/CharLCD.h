@@ -0,0 +1,87 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the CharLCD (CharLCD_I2C_v1_5) component and its I2C_CharLCD
+* master. CharLCD_CUSTOM_CHAR_SET is the customizer's custom character set,
+* none as in TopDesign unless set on the command line, and CharLCD_customFonts
+* the horizontal bar graph table it generates. An I2C write is handed to
+* mockI2cSink and completes at once, or when the host calls mockI2cComplete()
+* if mockI2cManual is set.
+*
+*******************************************************************************/
+#if !defined(CY_CHARLCD_CharLCD_H)
+#define CY_CHARLCD_CharLCD_H
+
+#include "cytypes.h"
+
+/* Custom character sets. */
+#define CharLCD_NONE                (0u)
+#define CharLCD_HORIZONTAL_BG       (1u)
+#define CharLCD_VERTICAL_BG         (2u)
+#define CharLCD_USER_DEFINED        (3u)
+#if !defined(CharLCD_CUSTOM_CHAR_SET)
+#define CharLCD_CUSTOM_CHAR_SET     (CharLCD_NONE)
+#endif
+
+extern uint8 const CYCODE CharLCD_customFonts[64u];
+
+void CharLCD_Start(void);
+void CharLCD_Position(uint8 row, uint8 column);
+void CharLCD_PrintString(char8 const string[]);
+void CharLCD_PutChar(char8 character);
+void CharLCD_WriteControl(uint8 cByte);
+void CharLCD_WriteData(uint8 dByte);
+
+#define CharLCD_DISPLAY_8_BIT_INIT  (0x38u)
+#define CharLCD_DISPLAY_4_BIT_INIT  (0x28u)
+#define CharLCD_DISPLAY_CURSOR_OFF  (0x08u)
+#define CharLCD_CLEAR_DISPLAY       (0x01u)
+#define CharLCD_CURSOR_AUTO_INCR_ON (0x06u)
+#define CharLCD_DISPLAY_CURSOR_ON   (0x0Eu)
+#define CharLCD_DISPLAY_ON_CURSOR_OFF (0x0Cu)
+#define CharLCD_CGRAM_0             (0x40u)
+#define CharLCD_DDRAM_0             (0x80u)
+#define CharLCD_CHARACTER_WIDTH     (0x05u)
+#define CharLCD_CHARACTER_HEIGHT    (0x08u)
+#define CharLCD_ROW_0_START         (0x80u)
+#define CharLCD_ROW_1_START         (0xC0u)
+#define CharLCD_ROW_2_START         (0x94u)
+#define CharLCD_ROW_3_START         (0xD4u)
+#define CharLCD_CUSTOM_0            (0x00u)
+#define CharLCD_CUSTOM_CHAR_SET_LEN (0x40u)
+#define CharLCD_INIT_DELAY          (20u)
+#define CharLCD_INIT_UP_NIB_DELAY   (5u)
+#define CharLCD_INIT_CMD_DELAY      (5u)
+#define CharLCD_I2C_SLAVE_ADDR      (0x27u)
+#define CharLCD_LOWER_NIB_SHIFT     (0x04u)
+#define CharLCD_LOWER_NIB_MASK      (0x0Fu)
+#define CharLCD_UPPER_NIB_MASK      (0xF0u)
+#define CharLCD_BLH                 (0x08u)
+#define CharLCD_EH                  (0x04u)
+#define CharLCD_RWH                 (0x02u)
+#define CharLCD_RSH                 (0x01u)
+
+/* I2C_CharLCD master. */
+#define I2C_CharLCD_MODE_COMPLETE_XFER      (0x00u)
+#define I2C_CharLCD_MODE_REPEAT_START       (0x01u)
+#define I2C_CharLCD_MODE_NO_STOP            (0x02u)
+#define I2C_CharLCD_MSTAT_RD_CMPLT          (0x01u)
+#define I2C_CharLCD_MSTAT_WR_CMPLT          (0x02u)
+#define I2C_CharLCD_MSTAT_XFER_INP          (0x04u)
+#define I2C_CharLCD_MSTAT_XFER_HALT         (0x08u)
+#define I2C_CharLCD_MSTAT_ERR_SHORT_XFER    (0x10u)
+#define I2C_CharLCD_MSTAT_ERR_ADDR_NAK      (0x20u)
+#define I2C_CharLCD_MSTAT_ERR_ARB_LOST      (0x40u)
+#define I2C_CharLCD_MSTAT_ERR_XFER          (0x80u)
+#define I2C_CharLCD_MSTR_NO_ERROR           (0x00u)
+#define I2C_CharLCD_MSTR_BUS_BUSY           (0x01u)
+#define I2C_CharLCD_MSTR_NOT_READY          (0x02u)
+
+void I2C_CharLCD_Start(void);
+uint8 I2C_CharLCD_MasterWriteBuf(uint8 slaveAddress, uint8 *wrData, uint8 cnt, uint8 mode);
+uint8 I2C_CharLCD_MasterStatus(void);
+uint8 I2C_CharLCD_MasterClearStatus(void);
+
+#endif /* CY_CHARLCD_CharLCD_H */
+
+/* [] END OF FILE */
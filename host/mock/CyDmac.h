@@ -0,0 +1,72 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of cy_boot CyDmac.h and the DMA channel components (VdacDma_L,
+* VdacDma_R, I2S_DMA). mock_psoc.c runs the TD chains: each
+* mockDmaRequest() moves one burst like a hardware request, and the working
+* TD reports its remaining count through CyDmaTdGetConfiguration() as the
+* PHUB updates it. Addresses are the upper and lower 16 bits the firmware
+* programs, so the host program must be linked without PIE to keep the
+* buffers below 4GB.
+*
+*******************************************************************************/
+#if !defined(CY_BOOT_CYDMAC_H)
+#define CY_BOOT_CYDMAC_H
+
+#include "cytypes.h"
+
+#define CY_DMA_NUMBER_OF_CHANNELS   (24u)
+#define CY_DMA_NUMBEROF_TDS         (128u)
+#define CY_DMA_INVALID_TD           (0xFFu)
+#define CY_DMA_END_CHAIN_TD         (0xFFu)
+#define CY_DMA_DISABLE_TD           (0xFEu)
+
+/* TD configuration flags. */
+#define TD_SWAP_EN                  (0x80u)
+#define TD_SWAP_SIZE4               (0x40u)
+#define TD_AUTO_EXEC_NEXT           (0x20u)
+#define TD_TERMIN_EN                (0x10u)
+#define TD_TERMOUT1_EN              (0x08u)
+#define TD_TERMOUT0_EN              (0x04u)
+#define TD_INC_DST_ADR              (0x02u)
+#define TD_INC_SRC_ADR              (0x01u)
+
+/* Channel status. */
+#define CY_DMA_STATUS_CHAIN_ACTIVE  (0x01u)
+#define CY_DMA_STATUS_TD_ACTIVE     (0x02u)
+
+#define CPU_REQ                     (0x01u)
+#define CPU_TERM_TD                 (0x02u)
+#define CPU_TERM_CHAIN              (0x04u)
+
+uint8 CyDmaTdAllocate(void);
+void CyDmaTdFree(uint8 tdHandle);
+cystatus CyDmaTdSetConfiguration(uint8 tdHandle, uint16 transferCount, uint8 nextTd, uint8 configuration);
+cystatus CyDmaTdGetConfiguration(uint8 tdHandle, uint16 *transferCount, uint8 *nextTd, uint8 *configuration);
+cystatus CyDmaTdSetAddress(uint8 tdHandle, uint16 source, uint16 destination);
+cystatus CyDmaTdGetAddress(uint8 tdHandle, uint16 *source, uint16 *destination);
+cystatus CyDmaChSetInitialTd(uint8 chHandle, uint8 startTd);
+cystatus CyDmaChEnable(uint8 chHandle, uint8 preserveTds);
+cystatus CyDmaChDisable(uint8 chHandle);
+cystatus CyDmaChStatus(uint8 chHandle, uint8 *currentTd, uint8 *state);
+cystatus CyDmaChSetRequest(uint8 chHandle, uint8 request);
+cystatus CyDmaClearPendingDrq(uint8 chHandle);
+
+/* DMA channel components. */
+#define VdacDma_L__TD_TERMOUT_EN    (TD_TERMOUT0_EN)
+#define VdacDma_R__TD_TERMOUT_EN    (TD_TERMOUT0_EN)
+#define I2S_DMA__TD_TERMOUT_EN      (TD_TERMOUT0_EN)
+
+uint8 VdacDma_L_DmaInitialize(uint8 burstCount, uint8 requestPerBurst, uint16 upperSrcAddress,
+                              uint16 upperDestAddress);
+void VdacDma_L_DmaRelease(void);
+uint8 VdacDma_R_DmaInitialize(uint8 burstCount, uint8 requestPerBurst, uint16 upperSrcAddress,
+                              uint16 upperDestAddress);
+void VdacDma_R_DmaRelease(void);
+uint8 I2S_DMA_DmaInitialize(uint8 burstCount, uint8 requestPerBurst, uint16 upperSrcAddress,
+                            uint16 upperDestAddress);
+void I2S_DMA_DmaRelease(void);
+
+#endif /* CY_BOOT_CYDMAC_H */
+
+/* [] END OF FILE */
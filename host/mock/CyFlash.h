@@ -0,0 +1,31 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of cy_boot CyFlash.h/CySpc.h: the EEPROM array and its row writes.
+* The EEPROM is mockEeprom[], read through CY_EEPROM_BASE like the memory
+* mapped array. mock_psoc.h has the fault injection for row writes.
+*
+*******************************************************************************/
+#if !defined(CY_BOOT_CYFLASH_H)
+#define CY_BOOT_CYFLASH_H
+
+#include "cytypes.h"
+
+#define CY_EEPROM_SIZEOF_ROW        (16u)
+#define CY_EEPROM_NUMBER_ROWS       (128u)
+#define CY_EEPROM_SIZE              (CY_EEPROM_SIZEOF_ROW * CY_EEPROM_NUMBER_ROWS)
+#define CY_SPC_FIRST_EE_ARRAYID     (0x40u)
+
+extern uint8 mockEeprom[CY_EEPROM_SIZE];
+#define CY_EEPROM_BASE              ((uintptr_t)mockEeprom)
+
+void CyEEPROM_Start(void);
+void CyEEPROM_Stop(void);
+void CyEEPROM_ReadReserve(void);
+void CyEEPROM_ReadRelease(void);
+cystatus CySetTemp(void);
+cystatus CyWriteRowData(uint8 arrayId, uint16 rowAddress, const uint8 *rowData);
+
+#endif /* CY_BOOT_CYFLASH_H */
+
+/* [] END OF FILE */
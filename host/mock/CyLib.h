@@ -0,0 +1,36 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of cy_boot CyLib.h: interrupt masking, delays and SysTick. The host
+* program is single threaded, so a critical section only tracks its nesting
+* depth (mockCriticalDepth) for tests that check it. Delays add to
+* mockDelayUs instead of waiting.
+*
+*******************************************************************************/
+#if !defined(CY_BOOT_CYLIB_H)
+#define CY_BOOT_CYLIB_H
+
+#include "cytypes.h"
+#include "cyfitter.h"
+#include "core_cm3.h"
+
+#define CyGlobalIntEnable           do { } while (0)
+#define CyGlobalIntDisable          do { } while (0)
+
+uint8 CyEnterCriticalSection(void);
+void CyExitCriticalSection(uint8 savedIntrStatus);
+
+void CyDelay(uint32 milliseconds);
+void CyDelayUs(uint16 microseconds);
+
+/* SysTick. The host calls mockSysTick() for each 1ms tick. */
+#define CY_SYS_SYST_NUM_OF_CALLBACKS    (5u)
+typedef void (*cySysTickCallback)(void);
+void CySysTickStart(void);
+void CySysTickStop(void);
+cySysTickCallback CySysTickSetCallback(uint32 number, cySysTickCallback function);
+cySysTickCallback CySysTickGetCallback(uint32 number);
+
+#endif /* CY_BOOT_CYLIB_H */
+
+/* [] END OF FILE */
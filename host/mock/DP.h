@@ -0,0 +1,27 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the DP (debug port) UART component. Transmitted bytes go to
+* mockUartSink, and the TX FIFO reports full while mockUartFull is set.
+*
+*******************************************************************************/
+#if !defined(CY_UART_DP_H)
+#define CY_UART_DP_H
+
+#include "cytypes.h"
+
+#define DP_TX_STS_COMPLETE          (0x01u)
+#define DP_TX_STS_FIFO_EMPTY        (0x02u)
+#define DP_TX_STS_FIFO_FULL         (0x04u)
+#define DP_TX_STS_FIFO_NOT_FULL     (0x08u)
+
+void DP_Start(void);
+void DP_Stop(void);
+void DP_PutString(const char8 string[]);
+void DP_PutChar(uint8 txDataByte);
+void DP_WriteTxData(uint8 txDataByte);
+uint8 DP_ReadTxStatus(void);
+
+#endif /* CY_UART_DP_H */
+
+/* [] END OF FILE */
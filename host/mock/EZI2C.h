@@ -0,0 +1,28 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the EZI2C slave component. The exposed buffer is recorded in
+* mockEzi2cBuffer/mockEzi2cSize, and EZI2C_GetActivity() returns
+* mockEzi2cActivity.
+*
+*******************************************************************************/
+#if !defined(CY_EZI2C_EZI2C_H)
+#define CY_EZI2C_EZI2C_H
+
+#include "cytypes.h"
+
+#define EZI2C_STATUS_READ1          (0x01u)
+#define EZI2C_STATUS_WRITE1         (0x02u)
+#define EZI2C_STATUS_READ2          (0x04u)
+#define EZI2C_STATUS_WRITE2         (0x08u)
+#define EZI2C_STATUS_BUSY           (0x10u)
+#define EZI2C_STATUS_ERR            (0x80u)
+
+void EZI2C_Start(void);
+void EZI2C_Stop(void);
+void EZI2C_SetBuffer1(uint16 bufSize, uint16 rwBoundary, volatile uint8 *dataPtr);
+uint8 EZI2C_GetActivity(void);
+
+#endif /* CY_EZI2C_EZI2C_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,20 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the FracDiv component (FracDiv_v1_1). The divider state is kept in
+* mockFracDiv for the host clock models.
+*
+*******************************************************************************/
+#if !defined(FracDiv_H)
+#define FracDiv_H
+
+#include "cytypes.h"
+
+void FracDiv_Start(void);
+void FracDiv_Stop(void);
+void FracDiv_Write(uint32 Y, uint32 X);
+void FracDiv_Init(void);
+
+#endif /* FracDiv_H */
+
+/* [] END OF FILE */
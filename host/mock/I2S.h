@@ -0,0 +1,28 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the I2S component. I2S_DATA_BITS is the component's data bits
+* setting, 16 as in TopDesign unless set on the command line.
+*
+*******************************************************************************/
+#if !defined(CY_I2S_I2S_H)
+#define CY_I2S_I2S_H
+
+#include "cytypes.h"
+
+#if !defined(I2S_DATA_BITS)
+#define I2S_DATA_BITS               (16u)
+#endif
+
+extern reg8 mockI2sTxFifo;
+#define I2S_TX_CH0_F0_PTR           (&mockI2sTxFifo)
+
+void I2S_Start(void);
+void I2S_Stop(void);
+void I2S_EnableTx(void);
+void I2S_DisableTx(void);
+void I2S_ClearTxFIFO(void);
+
+#endif /* CY_I2S_I2S_H */
+
+/* [] END OF FILE */
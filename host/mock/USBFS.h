@@ -0,0 +1,63 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the USBFS component API. The host delivers OUT packets with
+* mockUsbReceive(). USBFS_EP_MM selects the endpoint memory management as the
+* component customizer does: manual DMA (the project setting) by default, or
+* -DUSBFS_EP_MM=2 for DMA with automatic memory management, where the packet
+* lands in the buffer last given to USBFS_ReadOutEP().
+*
+*******************************************************************************/
+#if !defined(CY_USBFS_USBFS_H)
+#define CY_USBFS_USBFS_H
+
+#include "cytypes.h"
+
+#define USBFS__EP_MANUAL            (0u)
+#define USBFS__EP_DMAMANUAL         (1u)
+#define USBFS__EP_DMAAUTO           (2u)
+#if !defined(USBFS_EP_MM)
+#define USBFS_EP_MM                 (USBFS__EP_DMAMANUAL)
+#endif
+#define USBFS_EP_MANAGEMENT_MANUAL      (USBFS_EP_MM == USBFS__EP_MANUAL)
+#define USBFS_EP_MANAGEMENT_DMA_MANUAL  (USBFS_EP_MM == USBFS__EP_DMAMANUAL)
+#define USBFS_EP_MANAGEMENT_DMA_AUTO    (USBFS_EP_MM == USBFS__EP_DMAAUTO)
+
+#define USBFS_MAX_EP                (9u)
+#define USBFS_SAMPLE_FREQ_LEN       (3u)
+
+#define USBFS_3V_OPERATION          (0x00u)
+#define USBFS_5V_OPERATION          (0x01u)
+#define USBFS_DWR_VDDD_OPERATION    (0x02u)
+
+/* Endpoint states. */
+#define USBFS_NO_EVENT_PENDING      (0x00u)
+#define USBFS_EVENT_PENDING         (0x01u)
+#define USBFS_NO_EVENT_ALLOWED      (0x02u)
+#define USBFS_IN_BUFFER_FULL        (USBFS_NO_EVENT_PENDING)
+#define USBFS_IN_BUFFER_EMPTY       (USBFS_EVENT_PENDING)
+#define USBFS_OUT_BUFFER_FULL       (USBFS_EVENT_PENDING)
+#define USBFS_OUT_BUFFER_EMPTY      (USBFS_NO_EVENT_PENDING)
+
+#define USBFS_TRANS_STATE_IDLE      (0x00u)
+
+extern volatile uint8 USBFS_configuration;
+extern volatile uint8 USBFS_transferState;
+extern volatile uint8 USBFS_frequencyChanged;
+extern volatile uint8 USBFS_currentSampleFrequency[USBFS_MAX_EP][USBFS_SAMPLE_FREQ_LEN];
+
+void USBFS_Start(uint8 device, uint8 mode);
+void USBFS_Stop(void);
+uint8 USBFS_GetConfiguration(void);
+uint8 USBFS_IsConfigurationChanged(void);
+uint8 USBFS_GetInterfaceSetting(uint8 interfaceNumber);
+uint8 USBFS_GetEPState(uint8 epNumber);
+uint16 USBFS_GetEPCount(uint8 epNumber);
+void USBFS_EnableOutEP(uint8 epNumber);
+void USBFS_DisableOutEP(uint8 epNumber);
+uint16 USBFS_ReadOutEP(uint8 epNumber, uint8 *pData, uint16 length);
+void USBFS_LoadInEP(uint8 epNumber, const uint8 *pData, uint16 length);
+
+#endif /* CY_USBFS_USBFS_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,32 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the VDAC8_L/VDAC8_R and PGA_L/PGA_R/I2S_3v3 components. The data
+* registers are plain bytes, the DMAs hand their data to the host through the
+* sinks of mock_psoc.h instead.
+*
+*******************************************************************************/
+#if !defined(MOCK_VDAC8_H)
+#define MOCK_VDAC8_H
+
+#include "cytypes.h"
+
+extern reg8 mockVdacData[2];
+#define VDAC8_L_Data                (mockVdacData[0])
+#define VDAC8_L_Data_PTR            (&mockVdacData[0])
+#define VDAC8_R_Data                (mockVdacData[1])
+#define VDAC8_R_Data_PTR            (&mockVdacData[1])
+
+void VDAC8_L_Start(void);
+void VDAC8_L_Stop(void);
+void VDAC8_L_SetValue(uint8 value);
+void VDAC8_R_Start(void);
+void VDAC8_R_Stop(void);
+void VDAC8_R_SetValue(uint8 value);
+void PGA_L_Start(void);
+void PGA_R_Start(void);
+void I2S_3v3_Start(void);
+
+#endif /* MOCK_VDAC8_H */
+
+/* [] END OF FILE */
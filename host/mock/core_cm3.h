@@ -0,0 +1,38 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the CMSIS core_cm3.h intrinsics and DWT cycle counter registers.
+* Builds that profile on the host define PROFILER_HOST_CYCLES instead of
+* reading DWT (see profiler.h). __DMB() calls mockBarrier(), where tests may
+* preempt the code with an ISR (see mock_psoc.h).
+*
+*******************************************************************************/
+#if !defined(MOCK_CORE_CM3_H)
+#define MOCK_CORE_CM3_H
+
+#include "cytypes.h"
+
+#define __DMB()                     mockBarrier()
+#define __CLZ(x)                    ((uint8)((0u == (x)) ? 32 : __builtin_clz(x)))
+
+typedef struct {
+    volatile uint32 CTRL;
+    volatile uint32 CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    volatile uint32 DEMCR;
+} CoreDebug_Type;
+
+void mockBarrier(void);
+
+extern DWT_Type mockDwt;
+extern CoreDebug_Type mockCoreDebug;
+#define DWT                         (&mockDwt)
+#define CoreDebug                   (&mockCoreDebug)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1uL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk      (1uL)
+
+#endif /* MOCK_CORE_CM3_H */
+
+/* [] END OF FILE */
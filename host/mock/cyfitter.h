@@ -0,0 +1,16 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the generated cyfitter.h: clock and memory map constants.
+*
+*******************************************************************************/
+#if !defined(INCLUDED_CYFITTER_H)
+#define INCLUDED_CYFITTER_H
+
+#define BCLK__BUS_CLK__HZ           (64000000u)
+#define CYDEV_PERIPH_BASE           (0x40000000u)
+#define CYDEV_SRAM_BASE             (0x1FFF8000u)
+
+#endif /* INCLUDED_CYFITTER_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,63 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of cy_boot cytypes.h: the base types and macros used by the firmware.
+* The integer types have their exact widths on the host, so structures and
+* 64-bit arithmetic behave as on the Cortex-M3. The macro callbacks of the
+* project's cyapicallbacks.h come in here, as with cy_boot.
+*
+*******************************************************************************/
+#if !defined(CY_BOOT_CYTYPES_H)
+#define CY_BOOT_CYTYPES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cyapicallbacks.h"
+
+typedef uint8_t     uint8;
+typedef uint16_t    uint16;
+typedef uint32_t    uint32;
+typedef uint64_t    uint64;
+typedef int8_t      int8;
+typedef int16_t     int16;
+typedef int32_t     int32;
+typedef int64_t     int64;
+typedef char        char8;
+
+typedef volatile uint8  reg8;
+typedef volatile uint16 reg16;
+typedef volatile uint32 reg32;
+
+typedef uint32      cystatus;
+typedef void (*cyisraddress)(void);
+
+#define CYCODE                  const
+#define CY_ALIGN(align)         __attribute__ ((aligned(align)))
+#define CY_INLINE               __inline
+#define CY_ISR(FuncName)        void FuncName(void)
+#define CY_ISR_PROTO(FuncName)  void FuncName(void)
+
+#define LO8(x)                  ((uint8) ((x) & 0xFFu))
+#define HI8(x)                  ((uint8) ((uint16)(x) >> 8))
+#define LO16(x)                 ((uint16) ((x) & 0xFFFFu))
+#define HI16(x)                 ((uint16) ((uint32)(x) >> 16))
+
+#define CY_GET_REG8(addr)       (*((reg8 *)(addr)))
+#define CY_SET_REG8(addr, v)    (*((reg8 *)(addr)) = (uint8)(v))
+#define CY_GET_REG32(addr)      (*((reg32 *)(addr)))
+#define CY_SET_REG32(addr, v)   (*((reg32 *)(addr)) = (uint32)(v))
+
+#define CY_PSOC3                (0u)
+#define CY_PSOC4                (0u)
+#define CY_PSOC5LP              (1u)
+
+#define CYRET_SUCCESS           (0x00u)
+#define CYRET_BAD_PARAM         (0x01u)
+#define CYRET_INVALID_OBJECT    (0x02u)
+#define CYRET_LOCKED            (0x04u)
+#define CYRET_TIMEOUT           (0x10u)
+#define CYRET_UNKNOWN           ((cystatus) 0xFFFFFFFFu)
+
+#endif /* CY_BOOT_CYTYPES_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,27 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the FreqCapt and VdacDmaDone interrupt components. The host calls
+* the ISRs itself. VdacDmaDone can also be raised with mockVdacDmaDoneIrq(),
+* which runs the ISR set by VdacDmaDone_StartEx() unless it is disabled, and
+* keeps it pending until VdacDmaDone_Enable() otherwise.
+*
+*******************************************************************************/
+#if !defined(MOCK_INTERRUPTS_H)
+#define MOCK_INTERRUPTS_H
+
+#include "cytypes.h"
+
+void FreqCapt_StartEx(cyisraddress address);
+void FreqCapt_Stop(void);
+void FreqCapt_ClearPending(void);
+void VdacDmaDone_StartEx(cyisraddress address);
+void VdacDmaDone_Stop(void);
+void VdacDmaDone_ClearPending(void);
+void VdacDmaDone_Enable(void);
+void VdacDmaDone_Disable(void);
+void mockVdacDmaDoneIrq(void);
+
+#endif /* MOCK_INTERRUPTS_H */
+
+/* [] END OF FILE */
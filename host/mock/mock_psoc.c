@@ -0,0 +1,710 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock PSoC Creator APIs for the firmware modules built on the host.
+*
+*******************************************************************************/
+#include "mock_psoc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* CPU. */
+uint8 mockCriticalDepth = 0u;
+uint32 mockDelayUs = 0u;
+uint32 mockCycleCount = 0u;
+DWT_Type mockDwt;
+CoreDebug_Type mockCoreDebug;
+
+uint8 CyEnterCriticalSection(void) {
+    return mockCriticalDepth++;
+}
+
+void CyExitCriticalSection(uint8 savedIntrStatus) {
+    mockCriticalDepth = savedIntrStatus;
+}
+
+void CyDelay(uint32 milliseconds) {
+    mockDelayUs += milliseconds*1000u;
+}
+
+void CyDelayUs(uint16 microseconds) {
+    mockDelayUs += microseconds;
+}
+
+uint32 mockCycles(void) {
+    return mockCycleCount;
+}
+
+void (*mockBarrierHook)(void) = NULL;
+
+void mockBarrier(void) {
+    __sync_synchronize();
+    if (NULL != mockBarrierHook) {
+        mockBarrierHook();
+    }
+}
+
+/* SysTick. */
+static cySysTickCallback sysTickCallback[CY_SYS_SYST_NUM_OF_CALLBACKS];
+
+void CySysTickStart(void) {
+}
+
+void CySysTickStop(void) {
+}
+
+cySysTickCallback CySysTickSetCallback(uint32 number, cySysTickCallback function) {
+    cySysTickCallback old = sysTickCallback[number];
+
+    sysTickCallback[number] = function;
+    return old;
+}
+
+cySysTickCallback CySysTickGetCallback(uint32 number) {
+    return sysTickCallback[number];
+}
+
+void mockSysTick(void) {
+    uint32 i;
+
+    for (i = 0u; i < CY_SYS_SYST_NUM_OF_CALLBACKS; i++) {
+        if (NULL != sysTickCallback[i]) {
+            sysTickCallback[i]();
+        }
+    }
+}
+
+/* EEPROM. */
+uint8 mockEeprom[CY_EEPROM_SIZE];
+uint32 mockEepromWrites = 0u;
+cystatus mockEepromFailStatus = CYRET_SUCCESS;
+uint8 mockEepromTearBytes = 0u;
+
+void CyEEPROM_Start(void) {
+}
+
+void CyEEPROM_Stop(void) {
+}
+
+void CyEEPROM_ReadReserve(void) {
+}
+
+void CyEEPROM_ReadRelease(void) {
+}
+
+cystatus CySetTemp(void) {
+    return CYRET_SUCCESS;
+}
+
+cystatus CyWriteRowData(uint8 arrayId, uint16 rowAddress, const uint8 *rowData) {
+    uint8 *row = &mockEeprom[rowAddress*CY_EEPROM_SIZEOF_ROW];
+    cystatus status = mockEepromFailStatus;
+
+    if ((CY_SPC_FIRST_EE_ARRAYID != arrayId) || (rowAddress >= CY_EEPROM_NUMBER_ROWS)) {
+        return CYRET_BAD_PARAM;
+    }
+
+    mockEepromWrites++;
+    if (CYRET_SUCCESS != status) {
+        memcpy(row, rowData, mockEepromTearBytes);
+        mockEepromFailStatus = CYRET_SUCCESS;
+        mockEepromTearBytes = 0u;
+        return status;
+    }
+    memcpy(row, rowData, CY_EEPROM_SIZEOF_ROW);
+
+    return CYRET_SUCCESS;
+}
+
+/* DMA. */
+typedef struct {
+    uint16 count;
+    uint8 next;
+    uint8 config;
+    uint16 src;
+    uint16 dst;
+    uint8 used;
+} MOCK_TD;
+
+typedef struct {
+    uint16 srcHi;
+    uint16 dstHi;
+    uint8 burst;
+    uint8 td;               /* Current TD. */
+    uint16 left;            /* Bytes the current TD has left. */
+    uint16 offset;          /* Bytes the current TD has moved. */
+    uint8 enabled;
+    MOCK_DMA_SINK sink;
+} MOCK_CH;
+
+static MOCK_TD mockTd[CY_DMA_NUMBEROF_TDS];
+static MOCK_CH mockCh[CY_DMA_NUMBER_OF_CHANNELS];
+static uint8 mockChannels = 0u;
+
+uint8 CyDmaTdAllocate(void) {
+    uint8 i;
+
+    for (i = 0u; i < CY_DMA_NUMBEROF_TDS; i++) {
+        if (0u == mockTd[i].used) {
+            mockTd[i].used = 1u;
+            return i;
+        }
+    }
+    return CY_DMA_INVALID_TD;
+}
+
+void CyDmaTdFree(uint8 tdHandle) {
+    mockTd[tdHandle].used = 0u;
+}
+
+cystatus CyDmaTdSetConfiguration(uint8 tdHandle, uint16 transferCount, uint8 nextTd, uint8 configuration) {
+    mockTd[tdHandle].count = transferCount;
+    mockTd[tdHandle].next = nextTd;
+    mockTd[tdHandle].config = configuration;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaTdGetConfiguration(uint8 tdHandle, uint16 *transferCount, uint8 *nextTd, uint8 *configuration) {
+    uint16 count = mockTd[tdHandle].count;
+    uint8 i;
+
+    /* The working TD counts down as the PHUB moves its data. */
+    for (i = 0u; i < mockChannels; i++) {
+        if ((0u != mockCh[i].enabled) && (tdHandle == mockCh[i].td)) {
+            count = mockCh[i].left;
+        }
+    }
+    if (NULL != transferCount) {
+        *transferCount = count;
+    }
+    if (NULL != nextTd) {
+        *nextTd = mockTd[tdHandle].next;
+    }
+    if (NULL != configuration) {
+        *configuration = mockTd[tdHandle].config;
+    }
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaTdSetAddress(uint8 tdHandle, uint16 source, uint16 destination) {
+    mockTd[tdHandle].src = source;
+    mockTd[tdHandle].dst = destination;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaTdGetAddress(uint8 tdHandle, uint16 *source, uint16 *destination) {
+    if (NULL != source) {
+        *source = mockTd[tdHandle].src;
+    }
+    if (NULL != destination) {
+        *destination = mockTd[tdHandle].dst;
+    }
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChSetInitialTd(uint8 chHandle, uint8 startTd) {
+    mockCh[chHandle].td = startTd;
+    mockCh[chHandle].left = mockTd[startTd].count;
+    mockCh[chHandle].offset = 0u;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChEnable(uint8 chHandle, uint8 preserveTds) {
+    (void)preserveTds;
+    mockCh[chHandle].enabled = 1u;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChDisable(uint8 chHandle) {
+    mockCh[chHandle].enabled = 0u;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChStatus(uint8 chHandle, uint8 *currentTd, uint8 *state) {
+    if (NULL != currentTd) {
+        *currentTd = mockCh[chHandle].td;
+    }
+    if (NULL != state) {
+        *state = (0u != mockCh[chHandle].enabled) ? CY_DMA_STATUS_CHAIN_ACTIVE : 0u;
+    }
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaChSetRequest(uint8 chHandle, uint8 request) {
+    (void)chHandle;
+    (void)request;
+    return CYRET_SUCCESS;
+}
+
+cystatus CyDmaClearPendingDrq(uint8 chHandle) {
+    (void)chHandle;
+    return CYRET_SUCCESS;
+}
+
+static uint8 mockDmaInitialize(uint8 burstCount, uint16 upperSrcAddress, uint16 upperDestAddress) {
+    MOCK_CH *c = &mockCh[mockChannels];
+
+    c->srcHi = upperSrcAddress;
+    c->dstHi = upperDestAddress;
+    c->burst = burstCount;
+    return mockChannels++;
+}
+
+uint8 VdacDma_L_DmaInitialize(uint8 burstCount, uint8 requestPerBurst, uint16 upperSrcAddress,
+                              uint16 upperDestAddress) {
+    (void)requestPerBurst;
+    return mockDmaInitialize(burstCount, upperSrcAddress, upperDestAddress);
+}
+
+void VdacDma_L_DmaRelease(void) {
+}
+
+uint8 VdacDma_R_DmaInitialize(uint8 burstCount, uint8 requestPerBurst, uint16 upperSrcAddress,
+                              uint16 upperDestAddress) {
+    (void)requestPerBurst;
+    return mockDmaInitialize(burstCount, upperSrcAddress, upperDestAddress);
+}
+
+void VdacDma_R_DmaRelease(void) {
+}
+
+uint8 I2S_DMA_DmaInitialize(uint8 burstCount, uint8 requestPerBurst, uint16 upperSrcAddress,
+                            uint16 upperDestAddress) {
+    (void)requestPerBurst;
+    return mockDmaInitialize(burstCount, upperSrcAddress, upperDestAddress);
+}
+
+void I2S_DMA_DmaRelease(void) {
+}
+
+void mockDmaSetSink(uint8 ch, MOCK_DMA_SINK sink) {
+    mockCh[ch].sink = sink;
+}
+
+uint8 mockDmaEnabled(uint8 ch) {
+    return mockCh[ch].enabled;
+}
+
+uint8 mockDmaRequest(uint8 ch) {
+    MOCK_CH *c = &mockCh[ch];
+    MOCK_TD *td = &mockTd[c->td];
+    uint32 lo;
+    uint8 k;
+
+    if (0u == c->enabled) {
+        return 0u;
+    }
+
+    for (k = 0u; (k < c->burst) && (0u != c->left); k++) {
+        lo = td->src + ((0u != (td->config & TD_INC_SRC_ADR)) ? c->offset : 0u);
+        if (lo > 0xFFFFu) {
+            /* The PHUB does not carry into the upper address. */
+            fprintf(stderr, "mock DMA: channel %u source crosses a 64KB boundary\n", ch);
+            exit(2);
+        }
+        if (NULL != c->sink) {
+            c->sink(ch, *(const uint8 *)(uintptr_t)(((uint32)c->srcHi << 16) | lo));
+        }
+        c->offset++;
+        c->left--;
+    }
+
+    if (0u == c->left) {
+        c->td = td->next;
+        c->offset = 0u;
+        c->left = mockTd[c->td].count;
+        return (0u != (td->config & TD_TERMOUT0_EN)) ? 1u : 0u;
+    }
+    return 0u;
+}
+
+/* USBFS. */
+volatile uint8 USBFS_configuration = 0u;
+volatile uint8 USBFS_transferState = USBFS_TRANS_STATE_IDLE;
+volatile uint8 USBFS_frequencyChanged = 0u;
+volatile uint8 USBFS_currentSampleFrequency[USBFS_MAX_EP][USBFS_SAMPLE_FREQ_LEN];
+
+uint8 mockUsbAltSetting = 1u;
+uint8 mockUsbConfigChanged = 0u;
+uint32 mockUsbInCount = 0u;
+uint8 mockUsbInData[USBFS_MAX_EP][64u];
+
+static uint8 mockEpState[USBFS_MAX_EP];
+static uint8 mockEpEnabled[USBFS_MAX_EP];
+static uint16 mockEpCount[USBFS_MAX_EP];
+#if (USBFS_EP_MANAGEMENT_DMA_AUTO)
+static uint8 *mockEpDest[USBFS_MAX_EP];
+#else
+static uint8 mockEpData[USBFS_MAX_EP][1023u];
+#endif
+#if defined(USBFS_ARB_ISR_EXIT_CALLBACK)
+/* A copy started by USBFS_ReadOutEP() has yet to raise the arbiter ISR. */
+static uint8 mockArbPending = 0u;
+#endif
+
+void USBFS_Start(uint8 device, uint8 mode) {
+    (void)device;
+    (void)mode;
+    USBFS_configuration = 1u;
+    mockUsbConfigChanged = 1u;
+}
+
+void USBFS_Stop(void) {
+    USBFS_configuration = 0u;
+}
+
+uint8 USBFS_GetConfiguration(void) {
+    return USBFS_configuration;
+}
+
+uint8 USBFS_IsConfigurationChanged(void) {
+    uint8 changed = mockUsbConfigChanged;
+
+    mockUsbConfigChanged = 0u;
+    return changed;
+}
+
+uint8 USBFS_GetInterfaceSetting(uint8 interfaceNumber) {
+    (void)interfaceNumber;
+    return mockUsbAltSetting;
+}
+
+uint8 USBFS_GetEPState(uint8 epNumber) {
+    return mockEpState[epNumber];
+}
+
+uint16 USBFS_GetEPCount(uint8 epNumber) {
+    return mockEpCount[epNumber];
+}
+
+void USBFS_EnableOutEP(uint8 epNumber) {
+    mockEpEnabled[epNumber] = 1u;
+    mockEpState[epNumber] = USBFS_OUT_BUFFER_EMPTY;
+}
+
+void USBFS_DisableOutEP(uint8 epNumber) {
+    mockEpEnabled[epNumber] = 0u;
+}
+
+uint16 USBFS_ReadOutEP(uint8 epNumber, uint8 *pData, uint16 length) {
+#if (USBFS_EP_MANAGEMENT_DMA_AUTO)
+    /* Only sets the endpoint DMA destination. */
+    mockEpDest[epNumber] = pData;
+    return length;
+#else
+    length = (length > mockEpCount[epNumber]) ? mockEpCount[epNumber] : length;
+    memcpy(pData, mockEpData[epNumber], length);
+    mockEpState[epNumber] = USBFS_NO_EVENT_ALLOWED;
+#if defined(USBFS_ARB_ISR_EXIT_CALLBACK)
+    mockArbPending = 1u;
+#endif
+    return length;
+#endif
+}
+
+void USBFS_LoadInEP(uint8 epNumber, const uint8 *pData, uint16 length) {
+    length = (length > sizeof(mockUsbInData[0])) ? sizeof(mockUsbInData[0]) : length;
+    memcpy(mockUsbInData[epNumber], pData, length);
+    mockEpState[epNumber] = USBFS_IN_BUFFER_FULL;
+    mockUsbInCount++;
+}
+
+uint8 mockUsbReceive(uint8 ep, const uint8 *data, uint16 size) {
+    if ((0u == mockEpEnabled[ep]) || (USBFS_OUT_BUFFER_EMPTY != mockEpState[ep])) {
+        return 0u;
+    }
+#if (USBFS_EP_MANAGEMENT_DMA_AUTO)
+    if (NULL == mockEpDest[ep]) {
+        return 0u;
+    }
+    memcpy(mockEpDest[ep], data, size);
+#else
+    memcpy(mockEpData[ep], data, size);
+#endif
+    mockEpCount[ep] = size;
+    mockEpEnabled[ep] = 0u;
+    mockEpState[ep] = USBFS_OUT_BUFFER_FULL;
+
+    /* The EP2 ISR, then the arbiter ISR of the copy it started. */
+#if defined(USBFS_EP_2_ISR_EXIT_CALLBACK)
+    if (2u == ep) {
+        USBFS_EP_2_ISR_ExitCallback();
+    }
+#endif
+#if defined(USBFS_ARB_ISR_EXIT_CALLBACK)
+    if (0u != mockArbPending) {
+        mockArbPending = 0u;
+        USBFS_ARB_ISR_ExitCallback();
+    }
+#endif
+    return 1u;
+}
+
+/* VDAC8, PGA, I2S. */
+reg8 mockVdacData[2];
+reg8 mockI2sTxFifo;
+
+void VDAC8_L_Start(void) {
+}
+
+void VDAC8_L_Stop(void) {
+}
+
+void VDAC8_L_SetValue(uint8 value) {
+    mockVdacData[0] = value;
+}
+
+void VDAC8_R_Start(void) {
+}
+
+void VDAC8_R_Stop(void) {
+}
+
+void VDAC8_R_SetValue(uint8 value) {
+    mockVdacData[1] = value;
+}
+
+void PGA_L_Start(void) {
+}
+
+void PGA_R_Start(void) {
+}
+
+void I2S_3v3_Start(void) {
+}
+
+void I2S_Start(void) {
+}
+
+void I2S_Stop(void) {
+}
+
+void I2S_EnableTx(void) {
+}
+
+void I2S_DisableTx(void) {
+}
+
+void I2S_ClearTxFIFO(void) {
+}
+
+/* FracDiv and BitClk_Counter. */
+uint8 mockFracDivRunning = 0u;
+uint32 mockFracDivY = 0u;
+uint32 mockFracDivX = 0u;
+uint32 mockFracDivWrites = 0u;
+uint32 mockBitClkCount = 0u;
+
+void FracDiv_Start(void) {
+    mockFracDivRunning = 1u;
+}
+
+void FracDiv_Stop(void) {
+    mockFracDivRunning = 0u;
+}
+
+void FracDiv_Write(uint32 Y, uint32 X) {
+    mockFracDivY = Y;
+    mockFracDivX = X;
+    mockFracDivWrites++;
+}
+
+void FracDiv_Init(void) {
+}
+
+void BitClk_Counter_Start(void) {
+}
+
+void BitClk_Counter_Stop(void) {
+}
+
+uint32 BitClk_Counter_ReadCounter(void) {
+    return mockBitClkCount;
+}
+
+uint32 BitClk_Counter_ReadCapture(void) {
+    return mockBitClkCount;
+}
+
+void BitClk_Counter_ClearFIFO(void) {
+}
+
+/* Interrupt components. */
+void FreqCapt_StartEx(cyisraddress address) {
+    (void)address;
+}
+
+void FreqCapt_Stop(void) {
+}
+
+void FreqCapt_ClearPending(void) {
+}
+
+static cyisraddress vdacDmaDoneIsr = NULL;
+static uint8 vdacDmaDoneDisabled = 0u;
+static uint8 vdacDmaDonePending = 0u;
+
+void VdacDmaDone_StartEx(cyisraddress address) {
+    vdacDmaDoneIsr = address;
+    vdacDmaDoneDisabled = 0u;
+    vdacDmaDonePending = 0u;
+}
+
+void VdacDmaDone_Stop(void) {
+    vdacDmaDoneIsr = NULL;
+}
+
+void VdacDmaDone_ClearPending(void) {
+    vdacDmaDonePending = 0u;
+}
+
+void VdacDmaDone_Enable(void) {
+    vdacDmaDoneDisabled = 0u;
+    if (vdacDmaDonePending) {
+        vdacDmaDonePending = 0u;
+        mockVdacDmaDoneIrq();
+    }
+}
+
+void VdacDmaDone_Disable(void) {
+    vdacDmaDoneDisabled = 1u;
+}
+
+void mockVdacDmaDoneIrq(void) {
+    if (vdacDmaDoneDisabled) {
+        vdacDmaDonePending = 1u;
+    } else if (NULL != vdacDmaDoneIsr) {
+        vdacDmaDoneIsr();
+    }
+}
+
+/* CharLCD and its I2C master. */
+uint8 const CYCODE CharLCD_customFonts[64u] = {
+    0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u,
+    0x10u, 0x10u, 0x10u, 0x10u, 0x10u, 0x10u, 0x10u, 0x10u,
+    0x18u, 0x18u, 0x18u, 0x18u, 0x18u, 0x18u, 0x18u, 0x18u,
+    0x1Cu, 0x1Cu, 0x1Cu, 0x1Cu, 0x1Cu, 0x1Cu, 0x1Cu, 0x1Cu,
+    0x1Eu, 0x1Eu, 0x1Eu, 0x1Eu, 0x1Eu, 0x1Eu, 0x1Eu, 0x1Eu,
+    0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu, 0x1Fu,
+    0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u,
+    0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u
+};
+
+MOCK_I2C_SINK mockI2cSink = NULL;
+uint8 mockI2cManual = 0u;
+static uint8 mockI2cStatus = 0u;
+
+void CharLCD_Start(void) {
+}
+
+void CharLCD_Position(uint8 row, uint8 column) {
+    (void)row;
+    (void)column;
+}
+
+void CharLCD_PrintString(char8 const string[]) {
+    (void)string;
+}
+
+void CharLCD_PutChar(char8 character) {
+    (void)character;
+}
+
+void CharLCD_WriteControl(uint8 cByte) {
+    (void)cByte;
+}
+
+void CharLCD_WriteData(uint8 dByte) {
+    (void)dByte;
+}
+
+void I2C_CharLCD_Start(void) {
+}
+
+uint8 I2C_CharLCD_MasterWriteBuf(uint8 slaveAddress, uint8 *wrData, uint8 cnt, uint8 mode) {
+    (void)mode;
+    if (0u != (mockI2cStatus & I2C_CharLCD_MSTAT_XFER_INP)) {
+        return I2C_CharLCD_MSTR_BUS_BUSY;
+    }
+    if (NULL != mockI2cSink) {
+        mockI2cSink(slaveAddress, wrData, cnt);
+    }
+    mockI2cStatus = (0u != mockI2cManual) ? I2C_CharLCD_MSTAT_XFER_INP : I2C_CharLCD_MSTAT_WR_CMPLT;
+    return I2C_CharLCD_MSTR_NO_ERROR;
+}
+
+void mockI2cComplete(uint8 ok) {
+    if (0u != (mockI2cStatus & I2C_CharLCD_MSTAT_XFER_INP)) {
+        mockI2cStatus = (0u != ok) ? I2C_CharLCD_MSTAT_WR_CMPLT :
+                        (I2C_CharLCD_MSTAT_WR_CMPLT | I2C_CharLCD_MSTAT_ERR_ADDR_NAK | I2C_CharLCD_MSTAT_ERR_XFER);
+    }
+}
+
+uint8 I2C_CharLCD_MasterStatus(void) {
+    return mockI2cStatus;
+}
+
+uint8 I2C_CharLCD_MasterClearStatus(void) {
+    uint8 status = mockI2cStatus;
+
+    mockI2cStatus &= I2C_CharLCD_MSTAT_XFER_INP;
+    return status;
+}
+
+/* EZI2C. */
+volatile uint8 *mockEzi2cBuffer = NULL;
+uint16 mockEzi2cSize = 0u;
+uint16 mockEzi2cRwBoundary = 0u;
+uint8 mockEzi2cActivity = 0u;
+
+void EZI2C_Start(void) {
+}
+
+void EZI2C_Stop(void) {
+}
+
+void EZI2C_SetBuffer1(uint16 bufSize, uint16 rwBoundary, volatile uint8 *dataPtr) {
+    mockEzi2cSize = bufSize;
+    mockEzi2cRwBoundary = rwBoundary;
+    mockEzi2cBuffer = dataPtr;
+}
+
+uint8 EZI2C_GetActivity(void) {
+    uint8 activity = mockEzi2cActivity;
+
+    mockEzi2cActivity &= EZI2C_STATUS_BUSY;
+    return activity;
+}
+
+/* DP UART. */
+MOCK_UART_SINK mockUartSink = NULL;
+uint8 mockUartFull = 0u;
+
+void DP_Start(void) {
+}
+
+void DP_Stop(void) {
+}
+
+void DP_WriteTxData(uint8 txDataByte) {
+    if (NULL != mockUartSink) {
+        mockUartSink(txDataByte);
+    }
+}
+
+void DP_PutChar(uint8 txDataByte) {
+    DP_WriteTxData(txDataByte);
+}
+
+void DP_PutString(const char8 string[]) {
+    while ('\0' != *string) {
+        DP_WriteTxData((uint8)*string++);
+    }
+}
+
+uint8 DP_ReadTxStatus(void) {
+    return (0u != mockUartFull) ? DP_TX_STS_FIFO_FULL : (DP_TX_STS_FIFO_NOT_FULL | DP_TX_STS_FIFO_EMPTY);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,96 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Host side of the mock PSoC Creator APIs: the controls and observation
+* points that simulations and tests use in place of the hardware.
+*
+*******************************************************************************/
+#if !defined(MOCK_PSOC_H)
+#define MOCK_PSOC_H
+
+#include <project.h>
+
+/* Critical section nesting, and delays requested [us]. */
+extern uint8 mockCriticalDepth;
+extern uint32 mockDelayUs;
+
+/* Cycle count returned by mockCycles(), the PROFILER_HOST_CYCLES of the host
+ * build. Tests advance it themselves. */
+extern uint32 mockCycleCount;
+uint32 mockCycles(void);
+
+/* Called by each __DMB(), when set, i.e. where the ring is published or
+ * released: a test preempts the code there with what an ISR would do. */
+extern void (*mockBarrierHook)(void);
+
+/* Run the SysTick callbacks once, i.e. one 1ms tick. */
+void mockSysTick(void);
+
+/*
+ * DMA. mockDmaRequest() serves one request of channel ch: it moves one burst
+ * of the current TD, handing each byte read to the channel's sink, and moves
+ * on to the next TD at the end of the TD. Returns 1 when a TD with TERMOUT0
+ * enabled ended, i.e. the ISR wired to the channel is due.
+ */
+typedef void (*MOCK_DMA_SINK)(uint8 ch, uint8 data);
+void mockDmaSetSink(uint8 ch, MOCK_DMA_SINK sink);
+uint8 mockDmaRequest(uint8 ch);
+uint8 mockDmaEnabled(uint8 ch);
+
+/*
+ * USBFS. mockUsbReceive() delivers an OUT packet to endpoint ep like the SIE
+ * does: it is taken only while the endpoint is enabled and empty. Returns 1
+ * when taken. With AUDIO_OUT_ISR_MODE set, the EP2 ISR exit callback runs
+ * on a packet taken by EP2, and the arbiter ISR exit callback on a copy
+ * started by USBFS_ReadOutEP(), before it returns. mockUsbAltSetting is the
+ * alternate setting of every interface, and IN packets loaded are counted in
+ * mockUsbInCount with the last one in mockUsbInData.
+ */
+extern uint8 mockUsbAltSetting;
+extern uint8 mockUsbConfigChanged;
+extern uint32 mockUsbInCount;
+extern uint8 mockUsbInData[USBFS_MAX_EP][64u];
+uint8 mockUsbReceive(uint8 ep, const uint8 *data, uint16 size);
+
+/* FracDiv state, and the BitClk ticks counted in the last SOF period. */
+extern uint8 mockFracDivRunning;
+extern uint32 mockFracDivY;
+extern uint32 mockFracDivX;
+extern uint32 mockFracDivWrites;
+extern uint32 mockBitClkCount;
+
+/*
+ * EEPROM. Row writes are counted in mockEepromWrites. A row write fails with
+ * mockEepromFailStatus when it is not CYRET_SUCCESS; mockEepromTearBytes of
+ * the row are then written first, as by a reset in the middle of the write.
+ * Both are cleared by the failed write.
+ */
+extern uint32 mockEepromWrites;
+extern cystatus mockEepromFailStatus;
+extern uint8 mockEepromTearBytes;
+
+/*
+ * I2C_CharLCD master. Each write is handed to mockI2cSink. It completes at
+ * once, or, with mockI2cManual set, stays in progress until mockI2cComplete()
+ * ends it, with an error unless ok.
+ */
+typedef void (*MOCK_I2C_SINK)(uint8 address, const uint8 *data, uint8 count);
+extern MOCK_I2C_SINK mockI2cSink;
+extern uint8 mockI2cManual;
+void mockI2cComplete(uint8 ok);
+
+/* EZI2C buffer exposed and bus activity reported. */
+extern volatile uint8 *mockEzi2cBuffer;
+extern uint16 mockEzi2cSize;
+extern uint16 mockEzi2cRwBoundary;
+extern uint8 mockEzi2cActivity;
+
+/* DP UART. Bytes sent go to mockUartSink, the TX FIFO is full while
+ * mockUartFull is set. */
+typedef void (*MOCK_UART_SINK)(uint8 data);
+extern MOCK_UART_SINK mockUartSink;
+extern uint8 mockUartFull;
+
+#endif /* MOCK_PSOC_H */
+
+/* [] END OF FILE */
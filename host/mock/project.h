@@ -0,0 +1,31 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Mock of the generated project.h. It pulls in the mock cy_boot and component
+* headers in place of Generated_Source, so the firmware modules compile
+* unchanged on the host and link against mock_psoc.c. mock_psoc.h has the
+* host side of the mocks.
+*
+*******************************************************************************/
+#if !defined(MOCK_PROJECT_H)
+#define MOCK_PROJECT_H
+
+#include "cytypes.h"
+#include "cyfitter.h"
+#include "core_cm3.h"
+#include "CyLib.h"
+#include "CyFlash.h"
+#include "CyDmac.h"
+#include "USBFS.h"
+#include "VDAC8.h"
+#include "I2S.h"
+#include "FracDiv.h"
+#include "CharLCD.h"
+#include "EZI2C.h"
+#include "DP.h"
+#include "BitClk_Counter.h"
+#include "interrupts.h"
+
+#endif /* MOCK_PROJECT_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,37 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Minimal test helpers. TEST_CHECK() reports a failed condition with its
+* location and a message, and counts it; testResult() prints the summary and
+* gives the exit status of the test.
+*
+*******************************************************************************/
+#if !defined(TEST_H)
+#define TEST_H
+
+#include <stdio.h>
+
+static unsigned testFailures = 0u;
+
+#define TEST_CHECK(cond, ...)                                                   \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (testFailures++ < 10u) {                                         \
+                fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);                 \
+                fprintf(stderr, __VA_ARGS__);                                   \
+                fputc('\n', stderr);                                            \
+            }                                                                   \
+        }                                                                       \
+    } while (0)
+
+static int testResult(const char *name) {
+    printf("%s: %s", name, (0u == testFailures) ? "OK\n" : "FAILED");
+    if (0u != testFailures) {
+        printf(" (%u failures)\n", testFailures);
+    }
+    return (0u == testFailures) ? 0 : 1;
+}
+
+#endif /* TEST_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,125 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Asynchronous mode feedback loop (built with AUDIO_ASYNC_MODE set). The BitClk
+* runs at the nominal divider from a source clock off by a fixed offset, and
+* FreqCapt measures it against the 1ms SOF. The host sends each packet with
+* the frames its feedback accumulator gives, picking up the feedback value
+* every FB_REFRESH_MS frames, as bRefresh allows. The device takes fs*(1+ppm)
+* frames per second out of the ring, and the main loop runs servoFeedback()
+* every adjustInterval packets, as in main.c.
+*
+* The ring must never run dry or full. The buffered data size after each
+* packet, which is what the servo averages, must stay within a quarter packet
+* of the target once the first gate measurement is in, and within
+* FINAL_FRAMES over the last FINAL_MS of the run.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "clock_servo.h"
+#include "test.h"
+#include <math.h>
+#include <string.h>
+
+#define RUN_MS          (600000u)
+#define SETTLE_MS       (2000u)
+#define FINAL_MS        (100000u)
+#define FB_REFRESH_MS   (4u)
+#define FINAL_FRAMES    (1.5)
+
+/*******************************************************************************
+*  Run the loop at fs with offset ppm. Returns the largest deviation from the
+*  target after SETTLE_MS [frames], or a negative value if the ring ran dry or
+*  full, and the largest one over the last FINAL_MS in *worstFinal.
+*******************************************************************************/
+static double runLoop(uint32 fs, double ppm, double *worstFinal) {
+    CLOCK_SERVO s;
+    double out = fs*(1.0 + ppm*1e-6)/1000.0;
+    double count = 0.0;
+    double fill;
+    double hostAcc = 0.0;
+    double worst = 0.0;
+    uint32 feedback;
+    uint32 t;
+    uint16 n;
+
+    memset(&s, 0, sizeof(s));
+    setLatencyProfile(LATENCY_PROFILE_DEEP, fs);
+    servoSetRate(&s, fs);
+    fill = servoStartLevel(&s);
+    servoResetAverage(&s, (uint16)fill);
+    restartBitClkMeasure();
+    feedback = s.feedback;
+    *worstFinal = 0.0;
+
+    for (t = 1u; t <= RUN_MS; t++) {
+        /* SOF: BitClk counts of the last ms. */
+        count += out*I2S_CLOCK_FACTOR;
+        mockBitClkCount = (uint32)count;
+        count -= mockBitClkCount;
+        FreqCapt();
+
+        /* Host packet. */
+        if (0u == t % FB_REFRESH_MS) {
+            feedback = s.feedback;
+        }
+        hostAcc += feedback/16384.0;
+        n = (uint16)hostAcc;
+        hostAcc -= n;
+        fill += n;
+        if (fill > bufferSize) {
+            return -1.0;
+        }
+
+        /* Receive stage and servo. */
+        servoUpdateAverage(&s, (uint16)fill);
+        if (0u == t % adjustInterval) {
+            servoFeedback(&s, getBitClkFrequency(NULL));
+        }
+
+        if (t >= SETTLE_MS) {
+            worst = fmax(worst, fabs(fill - s.target));
+        }
+        if (t > RUN_MS - FINAL_MS) {
+            *worstFinal = fmax(*worstFinal, fabs(fill - s.target));
+        }
+
+        /* DMAs. */
+        fill -= out;
+        if (fill < 0.0) {
+            return -1.0;
+        }
+    }
+
+    return worst;
+}
+
+int main(void) {
+    static const uint32 rates[] = {44100u, 48000u, 96000u};
+    static const double offsets[] = {-500.0, -100.0, 0.0, 100.0, 500.0};
+    double worst;
+    double final;
+    uint8 o;
+    uint8 r;
+
+    initDMAs();
+    printf("deviation from the target [frames] after %us / over the last %us\n", SETTLE_MS/1000u,
+           FINAL_MS/1000u);
+    for (r = 0u; r < sizeof(rates)/sizeof(rates[0]); r++) {
+        printf("  %6lu Hz:", (unsigned long)rates[r]);
+        for (o = 0u; o < sizeof(offsets)/sizeof(offsets[0]); o++) {
+            worst = runLoop(rates[r], offsets[o], &final);
+            printf("  %+4.0fppm %4.1f/%3.1f", offsets[o], worst, final);
+            TEST_CHECK(worst >= 0.0, "%lu Hz %+.0fppm: ring ran dry or full", (unsigned long)rates[r], offsets[o]);
+            TEST_CHECK(worst <= rates[r]/4000.0, "%lu Hz %+.0fppm: %.1f frames off the target",
+                       (unsigned long)rates[r], offsets[o], worst);
+            TEST_CHECK(final <= FINAL_FRAMES, "%lu Hz %+.0fppm: %.1f frames off the target at the end",
+                       (unsigned long)rates[r], offsets[o], final);
+        }
+        printf("\n");
+    }
+
+    return testResult("test_async_fb");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,150 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* EEPROM trim records of clock_trim.c on the mock EEPROM, each trimLoad()
+* starting a power cycle.
+*  - Wear rules: one save per power cycle, none for a change below
+*    TRIM_SAVE_PPB, and none while the audio interface is streaming.
+*  - Rotation: saves go to the TRIM_ROWS rows in turn, each loading the
+*    previous one.
+*  - Torn and failed writes: the previous record stays current.
+*  - CRC: records are CRC-32 (zlib) checked, a bit error or another version
+*    makes the previous record current.
+*  - Sequence wrap: 0 follows 0xFFFFFFFF.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "clock_trim.h"
+#include "test.h"
+#include <stddef.h>
+#include <string.h>
+
+#define ROTATIONS       (20u)
+
+/* CRC-32 as zlib, independent of clock_trim.c. */
+static uint32 crc32(const uint8 *p, uint32 size) {
+    static uint32 table[256];
+    uint32 crc = 0xFFFFFFFFu;
+    uint32 c;
+    uint32 i;
+    uint8 b;
+
+    if (0u == table[1]) {
+        for (i = 0u; i < 256u; i++) {
+            for (c = i, b = 0u; b < 8u; b++) {
+                c = (0u != (c & 1u)) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+            }
+            table[i] = c;
+        }
+    }
+    while (0u != size--) {
+        crc = table[(crc ^ *p++) & 0xFFu] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+static TRIM_RECORD *record(uint8 row) {
+    return (TRIM_RECORD *)&mockEeprom[(TRIM_FIRST_ROW + row)*CY_EEPROM_SIZEOF_ROW];
+}
+
+static void putRecord(uint8 row, uint32 sequence, int32 trim) {
+    TRIM_RECORD *r = record(row);
+
+    r->magic = TRIM_MAGIC;
+    r->version = TRIM_VERSION;
+    r->reserved = 0u;
+    r->sequence = sequence;
+    r->trim = trim;
+    r->crc = crc32((const uint8 *)r, offsetof(TRIM_RECORD, crc));
+}
+
+/* Power cycle: returns the trim loaded, or -1 for none. */
+static int32 powerCycle(void) {
+    int32 trim = -1;
+
+    return trimLoad(&trim) ? trim : -1;
+}
+
+int main(void) {
+    static const uint8 check[] = "123456789";
+    uint32 writes;
+    int32 trim = 1234567;
+    uint8 row;
+    uint8 i;
+
+    TEST_CHECK(0xCBF43926u == crc32(check, 9u), "crc32 check value 0x%08lX", (unsigned long)crc32(check, 9u));
+
+    /* Audio stopped unless said otherwise. */
+    mockUsbAltSetting = 0u;
+
+    /* Blank EEPROM: the first save goes to the first row. */
+    memset(mockEeprom, 0xFF, sizeof(mockEeprom));
+    TEST_CHECK(-1 == powerCycle(), "record loaded from a blank EEPROM");
+    TEST_CHECK(1u == trimSave(trim), "first save refused");
+    TEST_CHECK((0u == record(0u)->sequence) && (trim == record(0u)->trim), "first record %lu/%ld",
+               (unsigned long)record(0u)->sequence, (long)record(0u)->trim);
+    TEST_CHECK(record(0u)->crc == crc32((const uint8 *)record(0u), offsetof(TRIM_RECORD, crc)),
+               "record CRC 0x%08lX", (unsigned long)record(0u)->crc);
+
+    /* Wear rules. */
+    writes = mockEepromWrites;
+    TEST_CHECK(0u == trimSave(trim + 5000), "second save in a power cycle");
+    TEST_CHECK(trim == powerCycle(), "trim not loaded");
+    TEST_CHECK(0u == trimSave(trim + TRIM_SAVE_PPB - 1), "change below TRIM_SAVE_PPB saved");
+    mockUsbAltSetting = 1u;
+    TEST_CHECK(0u == trimSave(trim + 5000), "saved while streaming");
+    mockUsbAltSetting = 0u;
+    TEST_CHECK(writes == mockEepromWrites, "%lu rows written", (unsigned long)(mockEepromWrites - writes));
+
+    /* Rotation: each power cycle saves a new trim in the next row. */
+    for (i = 0u; i < ROTATIONS; i++) {
+        TEST_CHECK(trim == powerCycle(), "rotation %u: previous trim not loaded", i);
+        trim += 2000;
+        TEST_CHECK(1u == trimSave(trim), "rotation %u: save refused", i);
+        row = (uint8)((i + 1u) % TRIM_ROWS);
+        TEST_CHECK((i + 1u == record(row)->sequence) && (trim == record(row)->trim),
+                   "rotation %u: row %u holds %lu/%ld", i, row, (unsigned long)record(row)->sequence,
+                   (long)record(row)->trim);
+    }
+    TEST_CHECK(1u + ROTATIONS == mockEepromWrites, "%lu rows written for %u saves",
+               (unsigned long)mockEepromWrites, 1u + ROTATIONS);
+
+    /* Torn write: reset after 9 bytes of the record. */
+    TEST_CHECK(trim == powerCycle(), "trim not loaded");
+    mockEepromFailStatus = CYRET_TIMEOUT;
+    mockEepromTearBytes = 9u;
+    TEST_CHECK(0u == trimSave(trim + 9000), "torn write reported saved");
+    TEST_CHECK(trim == powerCycle(), "torn record loaded");
+
+    /* Failed write: not retried in the same power cycle. */
+    mockEepromFailStatus = CYRET_TIMEOUT;
+    TEST_CHECK(0u == trimSave(trim + 9000), "failed write reported saved");
+    TEST_CHECK(0u == trimSave(trim + 9000), "failed write retried");
+    TEST_CHECK(trim == powerCycle(), "previous trim not kept");
+    TEST_CHECK(1u == trimSave(trim + 9000), "save after a failed write refused");
+    row = (uint8)((ROTATIONS + 1u) % TRIM_ROWS);
+    TEST_CHECK(trim + 9000 == record(row)->trim, "row %u holds %ld", row, (long)record(row)->trim);
+
+    /* CRC: a flipped trim bit or another version drops the newest record. */
+    record(row)->trim ^= 0x100;
+    TEST_CHECK(trim == powerCycle(), "corrupt record loaded");
+    record(row)->trim ^= 0x100;
+    TEST_CHECK(trim + 9000 == powerCycle(), "restored record not loaded");
+    record(row)->version = TRIM_VERSION + 1u;
+    TEST_CHECK(trim == powerCycle(), "record of another version loaded");
+
+    /* Sequence wrap. */
+    memset(mockEeprom, 0xFF, sizeof(mockEeprom));
+    putRecord(3u, 0xFFFFFFFFu, 111);
+    putRecord(4u, 0u, 222);
+    TEST_CHECK(222 == powerCycle(), "wrapped sequence not current");
+    TEST_CHECK(1u == trimSave(50000), "save after the wrap refused");
+    TEST_CHECK((1u == record(5u)->sequence) && (50000 == record(5u)->trim), "after the wrap row 5 holds %lu/%ld",
+               (unsigned long)record(5u)->sequence, (long)record(5u)->trim);
+    TEST_CHECK(50000 == powerCycle(), "record after the wrap not loaded");
+
+    return testResult("test_clock_trim");
+}
+
+/* [] END OF FILE */
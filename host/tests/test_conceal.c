@@ -0,0 +1,306 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Under-run handling of VdacDmaDone at 48kHz, 16-bit. The host sends 1ms
+* packets and stops for a while, the receive stage and the DMAs start at half
+* of the ring modelled as in audio_sim.c. Each frame sent carries a running
+* count on the left and full scale on the right, so the I2S stream tells the
+* frames received from the concealed ones. Built with AUDIO_CONCEAL=0 as
+* test_conceal_stop, the baseline that stops and refills in every profile.
+*  - Gap: the time no received frame is played, per profile and stall. The
+*    frames faded in are received ones. Steady streaming conceals nothing,
+*    and a stall plays at most GAP_SLACK_CHUNKS chunks more than the stall:
+*    concealment decides a chunk ahead.
+*  - The DEEP and MEDIUM profiles conceal, LOW stops the DMAs and refills.
+*  - VdacDmaDone never writes into the chunk the DMAs have started, and every
+*    frame received plays once, in order.
+*  - The same with VdacDmaDone raised in the middle of receiveOutPacket(): the
+*    DMAs play on up to the end of their chunk at each ring publish of the
+*    receive stage.
+*  - resetConceal(): a concealment in progress when the audio interface is
+*    stopped does not fade in the stream after the restart.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "audio_path.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+extern uint8 VdacOutDmaCh_L;
+extern uint8 VdacOutDmaCh_R;
+extern uint8 I2SDmaCh;
+
+#define FS              (48000u)
+#define FRAMES          (FS/1000u)
+#define STALL_AT_MS     (500u)
+#define RUN_MS          (1000u)
+#define GAP_SLACK_CHUNKS (1.0)
+#define REAL            (0x7FFF)
+
+typedef struct {
+    uint32 gap;             /* Frames without a received frame played. */
+    uint32 conceals;
+    uint32 stops;
+    uint32 stale;           /* Received frames played out of order. */
+    uint32 lost;            /* Received frames never played. */
+    uint32 faded;           /* Frames neither received, nor silence. */
+    uint32 startedWrites;   /* VdacDmaDone writes into the started chunk. */
+    uint32 preempted;       /* VdacDmaDone raised in receiveOutPacket(). */
+} CONCEAL_RESULT;
+
+static uint8 i2sOut[I2S_DATA_SIZE];
+static uint8 i2sBytes;
+static uint16 count;
+static uint16 lastCount;
+static uint16 lastGain;     /* Gain of the last frame faded in, or 0. */
+static int16 lastR;
+static uint32 played;
+static uint8 running;
+static CONCEAL_RESULT *result;
+static uint8 framesLeft;    /* Frames of the current ms left to play. */
+static uint8 receiving;
+
+static void i2sSink(uint8 ch, uint8 data) {
+    (void)ch;
+    i2sOut[i2sBytes++ % I2S_DATA_SIZE] = data;
+}
+
+/* VdacDmaDone, checking that the chunk started is left alone. */
+static CY_ISR(checkedDmaDone) {
+    static uint8 before[TRANSFER_SIZE*I2S_DATA_SIZE];
+    uint16 chunk = (uint16)(played % bufferSize);
+
+    memcpy(before, &soundBuffer_I2S[chunk*I2S_DATA_SIZE], transferSize*I2S_DATA_SIZE);
+    VdacDmaDone();
+    result->startedWrites += (0 == memcmp(before, &soundBuffer_I2S[chunk*I2S_DATA_SIZE],
+                                          transferSize*I2S_DATA_SIZE)) ? 0u : 1u;
+}
+
+/* Start streaming from scratch in profile. */
+static void start(uint8 profile) {
+    setLatencyProfile(profile, FS);
+    enableOutPacket();
+    played = 0u;
+    running = 0u;
+    i2sBytes = 0u;
+    lastCount = count;
+    lastGain = 0u;
+    lastR = REAL;
+}
+
+/* Fade gain of I2S frame l, r when it fades in the frame after lastCount, or
+ * 0. Fade-ins step the gain up from 1, fade-outs down to 0 and they scale a
+ * frame sent to r = 512*gain - 1. A fade-out can only end at gain 1 after
+ * gain 2. */
+static uint16 fadeInGain(uint16 l, int16 r) {
+    uint16 gain = (uint16)((r + 1)/512);
+    int16 expect = (int16)((((int32)(int16)(lastCount + 1u) << 16 >> AUDIO_FADE_LOG2)*gain) >> 16);
+
+    if ((r <= 0) || (r >= REAL) || (512*gain - 1 != r) || ((int16)l != expect)) {
+        return 0u;
+    }
+    return ((gain == lastGain + 1u) && ((1u != gain) || (2*512 - 1 != lastR))) ? gain : 0u;
+}
+
+/* Play up to framesLeft frames, up to the end of a chunk when toChunkEnd.
+ * Returns 1 when a chunk ended. */
+static uint8 play(uint8 toChunkEnd) {
+    uint8 term = 0u;
+    uint16 gain;
+    int16 step;
+    int16 r;
+    uint16 l;
+    uint8 k;
+
+    while ((framesLeft > 0u) && !(toChunkEnd && term)) {
+        framesLeft--;
+        if (0u != (flag & CONCEAL_FLAG)) {
+            flag &= ~CONCEAL_FLAG;
+            result->conceals++;
+        }
+        if (0u != (flag & DMA_STOP_FLAG)) {
+            flag &= ~DMA_STOP_FLAG;
+            running = 0u;
+            result->stops++;
+        }
+        if (0u == running) {
+            /* The DMAs stopped: nothing plays. */
+            result->gap += (0u != played) ? 1u : 0u;
+            continue;
+        }
+        term = mockDmaRequest(VdacOutDmaCh_L);
+        (void)mockDmaRequest(VdacOutDmaCh_R);
+        for (k = 0u; k < I2S_DATA_SIZE; k++) {
+            (void)mockDmaRequest(I2SDmaCh);
+        }
+        played++;
+
+        /* The I2S frame: big-endian left, right. */
+        l = (uint16)((i2sOut[0] << 8) | i2sOut[1]);
+        r = (int16)((i2sOut[2] << 8) | i2sOut[3]);
+        gain = fadeInGain(l, r);
+        if (REAL == r) {
+            step = (int16)(l - lastCount);
+            result->stale += (step > 0) ? 0u : 1u;
+            result->lost += (step > 1) ? (uint16)(step - 1) : 0u;
+            lastCount = l;
+        } else if (0u != gain) {
+            lastCount++;
+        } else {
+            result->gap++;
+        }
+        result->faded += ((REAL == r) || (0 == r)) ? 0u : 1u;
+        lastGain = gain;
+        lastR = r;
+
+        if (0u != term) {
+            mockVdacDmaDoneIrq();
+        }
+    }
+
+    return term;
+}
+
+/* The DMAs play on during receiveOutPacket(), once per packet. */
+static void preemptReceive(void) {
+    if (receiving) {
+        receiving = 0u;
+        result->preempted += play(1u);
+    }
+}
+
+/* Send the packet of one ms, when send, and play the frames of one ms. When
+ * preempt, VdacDmaDone may be raised in the middle of the receive stage. */
+static void runMs(uint8 send, uint8 preempt, CONCEAL_RESULT *res) {
+    static uint8 packet[USB_BUF_SIZE];
+    uint8 i;
+
+    result = res;
+    framesLeft = FRAMES;
+    if (send) {
+        for (i = 0u; i < FRAMES; i++) {
+            count++;
+            packet[4u*i] = (uint8)count;
+            packet[4u*i + 1u] = (uint8)(count >> 8);
+            packet[4u*i + 2u] = (uint8)REAL;
+            packet[4u*i + 3u] = (uint8)(REAL >> 8);
+        }
+        (void)mockUsbReceive(OUT_EP_NUM, packet, FRAMES*4u);
+        if (USBFS_OUT_BUFFER_FULL == USBFS_GetEPState(OUT_EP_NUM)) {
+            receiving = preempt;
+            receiveOutPacket();
+            receiving = 0u;
+        }
+        if ((0u == running) && ((int16)rxDist >= sHALF_BUFFER_SIZE)) {
+            running = 1u;
+        }
+    }
+    play(0u);
+}
+
+/* Stream with the host stopped for stall ms from STALL_AT_MS. */
+static void runStall(uint8 profile, uint16 stall, uint8 preempt, CONCEAL_RESULT *res) {
+    CONCEAL_RESULT warmUp;
+    uint32 t;
+
+    memset(res, 0, sizeof(*res));
+    start(profile);
+    for (t = 0u; t < RUN_MS; t++) {
+        runMs((t < STALL_AT_MS) || (t >= STALL_AT_MS + stall), preempt, (t < STALL_AT_MS/2u) ? &warmUp : res);
+    }
+}
+
+int main(void) {
+    static const uint16 stalls[] = {0u, 1u, 3u, 5u, 10u, 20u};
+    static const char *names[LATENCY_PROFILES] = {"DEEP", "MEDIUM", "LOW"};
+    CONCEAL_RESULT res;
+    double gap;
+    double slack;
+    uint32 preempted;
+    uint32 t;
+    uint8 profile;
+    uint8 preempt;
+    uint8 i;
+
+    initDMAs();
+    mockDmaSetSink(I2SDmaCh, &i2sSink);
+    mockBarrierHook = &preemptReceive;
+    VdacDmaDone_StartEx(&checkedDmaDone);
+    setAudioFormat(ALT_SETTING_16BIT);
+
+    for (preempt = 0u; preempt < 2u; preempt++) {
+        printf("gap [ms] per stall of");
+        for (i = 0u; i < sizeof(stalls)/sizeof(stalls[0]); i++) {
+            printf(" %5ums", stalls[i]);
+        }
+        printf("%s\n", (preempt) ? "   VdacDmaDone in receiveOutPacket()" : "");
+        preempted = 0u;
+        for (profile = 0u; profile < LATENCY_PROFILES; profile++) {
+            printf("  %-6s           ", names[profile]);
+            for (i = 0u; i < sizeof(stalls)/sizeof(stalls[0]); i++) {
+                runStall(profile, stalls[i], preempt, &res);
+                gap = (double)res.gap/FRAMES;
+                slack = GAP_SLACK_CHUNKS*transferSize/FRAMES;
+                preempted += res.preempted;
+                printf(" %7.2f", gap);
+
+                TEST_CHECK(0u == res.startedWrites, "%s %ums: %lu writes into the started chunk", names[profile],
+                           stalls[i], (unsigned long)res.startedWrites);
+                TEST_CHECK((0u == res.stale) && (0u == res.lost), "%s %ums: %lu stale frames, %lu lost",
+                           names[profile], stalls[i], (unsigned long)res.stale, (unsigned long)res.lost);
+                if (0u == stalls[i]) {
+                    TEST_CHECK((0u == res.gap) && (0u == res.conceals) && (0u == res.stops),
+                               "%s: %lu frames concealed or stopped while streaming", names[profile],
+                               (unsigned long)res.gap);
+                } else {
+                    TEST_CHECK(gap <= stalls[i] + slack, "%s %ums: %.2fms gap", names[profile], stalls[i], gap);
+                }
+#if (AUDIO_CONCEAL)
+                if (res.gap > 0u) {
+                    TEST_CHECK((LATENCY_PROFILE_LOW == profile) ? (0u == res.conceals) && (0u != res.stops) :
+                               (0u != res.conceals) && (0u == res.stops), "%s %ums: %lu concealments, %lu stops",
+                               names[profile], stalls[i], (unsigned long)res.conceals, (unsigned long)res.stops);
+                }
+#else
+                TEST_CHECK(0u == res.conceals, "%s %ums: %lu concealments", names[profile], stalls[i],
+                           (unsigned long)res.conceals);
+#endif
+            }
+            printf("   (%u x %u frames)\n", numOfBuffers, transferSize);
+        }
+        TEST_CHECK(!preempt || (0u != preempted), "VdacDmaDone never raised in receiveOutPacket()");
+    }
+
+#if (AUDIO_CONCEAL)
+    /* Audio OFF in the middle of a concealment, then ON again. */
+    memset(&res, 0, sizeof(res));
+    start(LATENCY_PROFILE_DEEP);
+    for (t = 0u; t < STALL_AT_MS; t++) {
+        runMs(1u, 0u, &res);
+    }
+    for (t = 0u; t < 20u; t++) {
+        runMs(0u, 0u, &res);
+    }
+    TEST_CHECK(0u != res.conceals, "no concealment before the restart");
+    running = 0u;
+    resetConceal();
+    memset(&res, 0, sizeof(res));
+    for (t = 0u; t < STALL_AT_MS; t++) {
+        runMs(1u, 0u, &res);
+    }
+    TEST_CHECK((0u == res.faded) && (0u == res.stale) && (0u == res.conceals),
+               "after the restart: %lu faded frames, %lu stale, %lu concealments", (unsigned long)res.faded,
+               (unsigned long)res.stale, (unsigned long)res.conceals);
+#else
+    (void)t;
+#endif
+
+#if (AUDIO_CONCEAL)
+    return testResult("test_conceal");
+#else
+    return testResult("test_conceal_stop");
+#endif
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,9 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* test_conceal built with AUDIO_CONCEAL=0: the stop and refill baseline.
+*
+*******************************************************************************/
+#include "test_conceal.c"
+
+/* [] END OF FILE */
@@ -0,0 +1,82 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* DMA transfer points of getOutIndex(). The DMAs run over three times the
+* ring in every latency profile and at 44.1/48/96kHz, the I2S DMA with three
+* or four 1-byte bursts per frame so it is caught within a frame. Each
+* position has to match the bytes the channel has sent, which the mock DMA
+* sinks count: the frame the DMA is in, modulo the ring. For the I2S DMA this
+* is the frame its partial frame belongs to. Also built with 24-bit I2S
+* (test_dma_position24), where the byte count is divided rather than shifted.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "audio_path.h"
+#include "test.h"
+
+extern uint8 VdacOutDmaCh_L;
+extern uint8 VdacOutDmaCh_R;
+extern uint8 I2SDmaCh;
+
+static uint32 sent[CY_DMA_NUMBER_OF_CHANNELS];
+
+static void countByte(uint8 ch, uint8 data) {
+    (void)data;
+    sent[ch]++;
+}
+
+int main(void) {
+    static const uint32 rates[] = {44100u, 48000u, 96000u};
+    DMA_POSITION pos;
+    uint32 checked = 0u;
+    uint32 k;
+    uint8 profile;
+    uint8 term;
+    uint8 r;
+    uint8 q;
+
+    initDMAs();
+    mockDmaSetSink(VdacOutDmaCh_L, &countByte);
+    mockDmaSetSink(VdacOutDmaCh_R, &countByte);
+    mockDmaSetSink(I2SDmaCh, &countByte);
+
+    for (profile = 0u; profile < LATENCY_PROFILES; profile++) {
+        for (r = 0u; r < sizeof(rates)/sizeof(rates[0]); r++) {
+            setLatencyProfile(profile, rates[r]);
+            sent[VdacOutDmaCh_L] = 0u;
+            sent[VdacOutDmaCh_R] = 0u;
+            sent[I2SDmaCh] = 0u;
+
+            for (k = 0u; k < 3u*bufferSize; k++) {
+                getOutIndex(&pos);
+                TEST_CHECK(pos.vdacL == sent[VdacOutDmaCh_L] % bufferSize, "profile %u %lu Hz: VDAC_L at %u, sent %lu",
+                           profile, (unsigned long)rates[r], pos.vdacL, (unsigned long)sent[VdacOutDmaCh_L]);
+                if (USE_VDAC_OUTPUT) {
+                    TEST_CHECK(pos.vdacR == sent[VdacOutDmaCh_R] % bufferSize, "profile %u %lu Hz: VDAC_R at %u",
+                               profile, (unsigned long)rates[r], pos.vdacR);
+                }
+                if (USE_I2S_OUTPUT) {
+                    TEST_CHECK(pos.i2s == (sent[I2SDmaCh]/I2S_DATA_SIZE) % bufferSize,
+                               "profile %u %lu Hz: I2S at %u, sent %lu bytes", profile, (unsigned long)rates[r],
+                               pos.i2s, (unsigned long)sent[I2SDmaCh]);
+                }
+                checked++;
+
+                /* One frame on the VDACs, three or four bytes of I2S. */
+                term = mockDmaRequest(VdacOutDmaCh_L);
+                (void)mockDmaRequest(VdacOutDmaCh_R);
+                for (q = 0u; q < ((0u == k % 3u) ? 3u : 4u)*I2S_DATA_SIZE/4u; q++) {
+                    (void)mockDmaRequest(I2SDmaCh);
+                }
+                if (0u != term) {
+                    VdacDmaDone();
+                }
+            }
+        }
+    }
+    printf("%lu positions checked, %u-bit I2S\n", (unsigned long)checked, I2S_DATA_BITS);
+
+    return testResult((24u == I2S_DATA_BITS) ? "test_dma_position24" : "test_dma_position");
+}
+
+/* [] END OF FILE */
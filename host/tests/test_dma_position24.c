@@ -0,0 +1,9 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* test_dma_position built with 24-bit I2S (6-byte frames).
+*
+*******************************************************************************/
+#include "test_dma_position.c"
+
+/* [] END OF FILE */
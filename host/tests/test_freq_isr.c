@@ -0,0 +1,119 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* FreqCapt gate measurement and its ISR cost against the float IIR it replaced.
+*  - A restart skips BITCLK_START_WAIT counts, then publishes the sum of
+*    BITCLK_GATE counts, which getBitClkFrequency() converts to Q24.8 Hz.
+*  - A stopped BitClk (zero count) discards the running window.
+*  - Cycle estimate of one FreqCapt call on the Cortex-M3 for both versions,
+*    from the operations each one executes and the cost of the libgcc
+*    soft-float routines. There is no target toolchain in the host build, so
+*    this is a model and not a measurement; PROFILE_FREQ_ISR measures it on
+*    the board.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "clock_servo.h"
+#include "test.h"
+
+/* Operation of the cycle model and its Cortex-M3 cost [cycles]. */
+typedef struct {
+    const char *name;
+    uint16 cycles;
+} ISR_OP;
+
+static const ISR_OP isrOps[] = {
+    {"exception entry and exit",    24u},   /* Stacking 12, unstacking 12. */
+    {"component API call",          8u},    /* BL, register access, BX. */
+    {"load/store",                  2u},
+    {"ALU or compare",              1u},
+    {"taken branch",                3u},
+    {"__aeabi_ui2f",                25u},   /* libgcc soft-float, Cortex-M3. */
+    {"__aeabi_fmul",                55u},
+    {"__aeabi_fdiv",                110u},
+    {"__aeabi_fadd",                65u},
+    {"__aeabi_fcmp",                30u},
+};
+#define OPS         (sizeof(isrOps)/sizeof(isrOps[0]))
+
+/* Operations of one call in the steady state. Float IIR: count*1000/factor,
+ * the > 0 and == 0 compares, f*0.8 + t*0.2. Integer sum: restart and zero
+ * checks, wait check, sum and gate count update, gate end compare. */
+static const uint8 floatIirOps[OPS] = {1u, 2u, 6u, 2u, 2u, 1u, 3u, 1u, 1u, 2u};
+static const uint8 gateSumOps[OPS]  = {1u, 2u, 7u, 5u, 2u, 0u, 0u, 0u, 0u, 0u};
+
+static uint32 isrCycles(const uint8 *ops) {
+    uint32 cycles = 0u;
+    uint8 i;
+
+    for (i = 0u; i < OPS; i++) {
+        cycles += (uint32)ops[i]*isrOps[i].cycles;
+    }
+    return cycles;
+}
+
+/* Capture count at the USB SOF. */
+static void sof(uint32 count) {
+    mockBitClkCount = count;
+    FreqCapt();
+}
+
+int main(void) {
+    uint32 seq;
+    uint32 seq0;
+    uint32 freq;
+    uint32 sum = 0u;
+    uint32 expected;
+    uint32 floatCycles = isrCycles(floatIirOps);
+    uint32 gateCycles = isrCycles(gateSumOps);
+    uint16 i;
+
+    /* 48kHz with 16-bit I2S: 3072 counts per ms, one extra every 4th. */
+    restartBitClkMeasure();
+    sof(3072u);
+    freq = getBitClkFrequency(&seq0);
+    TEST_CHECK(0u == freq, "restart publishes %lu, not 0", (unsigned long)freq);
+    for (i = 1u; i < BITCLK_START_WAIT; i++) {
+        sof(1u);
+    }
+    for (i = 0u; i < BITCLK_GATE; i++) {
+        sof(3072u + (0u == (i & 3u)));
+        sum += 3072u + (0u == (i & 3u));
+        freq = getBitClkFrequency(&seq);
+        TEST_CHECK((i + 1u < BITCLK_GATE) == (seq == seq0), "published after %u counts", i + 1u);
+    }
+    expected = (uint32)((((uint64)sum*1000u) << SERVO_FREQ_Q)/I2S_CLOCK_FACTOR/BITCLK_GATE);
+    TEST_CHECK(freq == expected, "gate result %lu, expected %lu", (unsigned long)freq, (unsigned long)expected);
+    TEST_CHECK((freq >> SERVO_FREQ_Q) == 48003u, "48kHz + 1/4 count per ms reads %lu Hz",
+               (unsigned long)(freq >> SERVO_FREQ_Q));
+
+    /* A stopped BitClk discards the running window. */
+    for (i = 0u; i < BITCLK_GATE/2u; i++) {
+        sof(3000u);
+    }
+    sof(0u);
+    for (i = 0u; i < BITCLK_START_WAIT; i++) {
+        sof(1u);
+    }
+    seq0 = seq;
+    for (i = 0u; i < BITCLK_GATE; i++) {
+        sof(3072u);
+    }
+    freq = getBitClkFrequency(&seq);
+    TEST_CHECK(seq == seq0 + 1u, "one window published after the stop, seq %lu", (unsigned long)(seq - seq0));
+    TEST_CHECK(freq == (48000u << SERVO_FREQ_Q), "after the stop reads %lu, not 48000 Hz",
+               (unsigned long)(freq >> SERVO_FREQ_Q));
+
+    printf("FreqCapt cycle estimate     float IIR  gate sum\n");
+    for (i = 0u; i < OPS; i++) {
+        printf("  %-26s %6u x%-3u %3u x%u\n", isrOps[i].name, floatIirOps[i], isrOps[i].cycles,
+               gateSumOps[i], isrOps[i].cycles);
+    }
+    printf("FreqCapt cycle estimate: float IIR %lu, gate sum %lu cycles per call (%.1fx)\n",
+           (unsigned long)floatCycles, (unsigned long)gateCycles, (double)floatCycles/gateCycles);
+    TEST_CHECK(gateCycles*4u < floatCycles, "gate sum is not cheaper");
+
+    return testResult("test_freq_isr");
+}
+
+/* [] END OF FILE */
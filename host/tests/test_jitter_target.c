@@ -0,0 +1,237 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Adaptive buffered data size target (built with SERVO_ADAPTIVE_TARGET set)
+* against the fixed one. The host sends one packet per 1ms frame, delayed at
+* the receive stage by a jitter trace, with a source clock off by a fixed
+* offset. The DMAs take the frames out at the FracDiv rate, FreqCapt counts
+* the BitClk every SOF, and the servo runs as in main.c. An under-run stops
+* the DMAs until the target is reached again, as with AUDIO_CONCEAL off. The
+* fixed target runs without servoTrackJitter(), which keeps the target at half
+* of the ring with the UpperAdjustRange dead band, as the build without
+* SERVO_ADAPTIVE_TARGET does. Both run the same traces.
+*  - Every case: the adaptive target under-runs no more than the fixed one.
+*    Without under-runs, the divider settles within DIV_PPM_TOLERANCE of the
+*    source offset, i.e. the offset is applied and compensated. The restarts
+*    after under-runs pull the divider off by the fill level instead.
+*  - Steady, light and heavy jitter in the DEEP profile: no under-runs, and a
+*    buffering delay below that of the fixed target.
+*  - Bursts of 6ms: no under-runs in the DEEP profile.
+*  - The rings at 96kHz and of MEDIUM hold 10.7ms, too short to ride out the
+*    10ms stalls with either target.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "clock_servo.h"
+#include "test.h"
+#include <math.h>
+#include <string.h>
+
+#define RUN_MS          (300000u)
+#define SETTLE_MS       (60000u)
+#define TRACES          (5u)
+#define TRACE_BURST     (3u)
+#define TRACE_STALL     (4u)
+#define DIV_PPM_TOLERANCE (20.0)
+
+static const char *const traceName[TRACES] = {"steady", "light", "heavy", "burst", "stall"};
+static uint32 rngState = 7u;
+
+static double urand(void) {
+    rngState = rngState*1664525u + 1013904223u;
+    return (rngState >> 8)/16777216.0;
+}
+
+/* Receive stage delay of packet k [ms]. */
+static double jitterAt(uint8 trace, uint32 k) {
+    switch (trace) {
+    case 1u:
+        return 0.5*urand();
+    case 2u:
+        return 2.0*urand();
+    case TRACE_BURST:
+        return ((k % 250u < 6u) ? (double)(k % 250u) : 0.0) + 0.3*urand();
+    case TRACE_STALL:
+        return ((k % 500u < 10u) ? (double)(k % 500u) : 0.0) + 0.3*urand();
+    default:
+        return 0.0;
+    }
+}
+
+typedef struct {
+    double latency;     /* Mean buffering delay after SETTLE_MS [ms]. */
+    uint32 underruns;
+    uint32 drops;
+    uint16 target;
+    double divPpm;      /* Mean divider offset after SETTLE_MS [ppm]. */
+} JITTER_RESULT;
+
+/* FracDiv output [frames/s] for divider value div and source offset ppm. */
+static double frameRate(uint32 div, double ppm) {
+    return DIVIDER_SOURCE_FREQ*(1.0 + ppm*1e-6)*((double)div/div_MAX)/I2S_CLOCK_FACTOR;
+}
+
+static void runTrace(uint8 trace, uint8 profile, uint32 fs, double ppm, uint8 adaptive, JITTER_RESULT *res) {
+    const double nominal = (double)fs*I2S_CLOCK_FACTOR*div_MAX/DIVIDER_SOURCE_FREQ;
+    CLOCK_SERVO s;
+    double consumed = 0.0;
+    double chunkEnd = 0.0;
+    double last = 0.0;
+    double acc = 0.0;
+    double count = 0.0;
+    double latSum = 0.0;
+    double divSum = 0.0;
+    double t;
+    double rate;
+    uint32 written = 0u;
+    uint32 latN = 0u;
+    uint32 seq = 0u;
+    uint32 lastSeq = 0u;
+    uint32 servoTime = 0u;
+    uint32 freq;
+    uint32 k;
+    uint16 dist;
+    uint16 n;
+    uint8 running = 0u;
+
+    memset(&s, 0, sizeof(s));
+    memset(res, 0, sizeof(*res));
+    rngState = 7u;
+    setLatencyProfile(profile, fs);
+    servoSetRate(&s, fs);
+    servoResetAverage(&s, 0u);
+
+    for (k = 0u; k < RUN_MS; k++) {
+        rate = frameRate(s.div, ppm)/1000.0;
+
+        /* SOF: BitClk counts of the last ms. */
+        count += (running) ? rate*I2S_CLOCK_FACTOR : 0.0;
+        mockBitClkCount = (uint32)count;
+        count -= mockBitClkCount;
+        FreqCapt();
+
+        /* DMAs up to the packet's arrival. An under-run is a chunk end with
+        * less than a chunk left. */
+        t = fmax(last, k + jitterAt(trace, k));
+        if (running) {
+            consumed += (t - last)*rate;
+            while (running && (consumed >= chunkEnd)) {
+                chunkEnd += transferSize;
+                if (written < chunkEnd) {
+                    consumed = chunkEnd - transferSize;
+                    running = 0u;
+                    res->underruns++;
+                }
+            }
+        }
+        last = t;
+
+        /* Receive stage. */
+        acc += fs/1000.0;
+        n = (uint16)acc;
+        acc -= n;
+        if (written - consumed + n > bufferSize) {
+            res->drops++;
+        } else {
+            written += n;
+        }
+        dist = (uint16)(written - (uint32)consumed);
+        servoUpdateAverage(&s, dist);
+        if (running && adaptive) {
+            servoTrackJitter(&s, dist);
+        }
+        if (!running && (dist >= servoStartLevel(&s))) {
+            running = 1u;
+            servoResetAverage(&s, dist);
+            restartBitClkMeasure();
+            chunkEnd = consumed + transferSize;
+            servoTime = k;
+        }
+
+        /* Servo. */
+        if (running) {
+#if (SERVO_PI_CONTROL)
+            if (k - servoTime >= SERVO_PI_PERIOD_MS) {
+                servoTime += SERVO_PI_PERIOD_MS;
+                freq = getBitClkFrequency(&seq);
+                (void)servoControl(&s, freq, seq != lastSeq);
+                lastSeq = seq;
+            }
+#else
+            (void)servoTime;
+            if (0u == k % adjustInterval) {
+                freq = getBitClkFrequency(&seq);
+                (void)servoAdjust(&s, freq, seq != lastSeq);
+                lastSeq = seq;
+            }
+#endif
+        }
+
+        if (running && (k >= SETTLE_MS)) {
+            latSum += dist;
+            divSum += (s.div/nominal - 1.0)*1e6;
+            latN++;
+        }
+    }
+
+    res->latency = (0u != latN) ? latSum/latN*1000.0/fs : 0.0;
+    res->divPpm = (0u != latN) ? divSum/latN : 0.0;
+    res->target = s.target;
+}
+
+int main(void) {
+    static const uint32 rates[] = {48000u, 96000u};
+    static const double offsets[] = {100.0, -300.0};
+    static const uint8 profiles[] = {LATENCY_PROFILE_DEEP, LATENCY_PROFILE_MEDIUM};
+    JITTER_RESULT fixed;
+    JITTER_RESULT res;
+    double half;
+    uint8 p;
+    uint8 r;
+    uint8 o;
+    uint8 j;
+
+    initDMAs();
+    printf("buffering delay [ms] / under-runs per trace, fixed -> adaptive target, divider offset [ppm]\n");
+    for (p = 0u; p < sizeof(profiles); p++) {
+        for (r = 0u; r < sizeof(rates)/sizeof(rates[0]); r++) {
+            for (o = 0u; o < sizeof(offsets)/sizeof(offsets[0]); o++) {
+                setLatencyProfile(profiles[p], rates[r]);
+                half = bufferSize/2.0*1000.0/rates[r];
+                printf("  %s %5lu Hz %+4.0fppm (%ux%u, half %4.1f):", (LATENCY_PROFILE_DEEP == profiles[p]) ? "DEEP  " : "MEDIUM",
+                       (unsigned long)rates[r], offsets[o], numOfBuffers, transferSize, half);
+                for (j = 0u; j < TRACES; j++) {
+                    runTrace(j, profiles[p], rates[r], offsets[o], 0u, &fixed);
+                    runTrace(j, profiles[p], rates[r], offsets[o], 1u, &res);
+                    printf(" %s %4.1f/%lu -> %4.1f/%lu", traceName[j], fixed.latency, (unsigned long)fixed.underruns,
+                           res.latency, (unsigned long)res.underruns);
+
+                    TEST_CHECK(res.underruns <= fixed.underruns, "%lu Hz %+.0fppm %s: %lu under-runs, fixed %lu",
+                               (unsigned long)rates[r], offsets[o], traceName[j], (unsigned long)res.underruns,
+                               (unsigned long)fixed.underruns);
+                    TEST_CHECK((0u != fixed.underruns) || (0u != res.underruns) ||
+                               ((fabs(fixed.divPpm + offsets[o]) < DIV_PPM_TOLERANCE) &&
+                                (fabs(res.divPpm + offsets[o]) < DIV_PPM_TOLERANCE)),
+                               "%lu Hz %+.0fppm %s: divider at %+.1fppm, fixed %+.1fppm", (unsigned long)rates[r],
+                               offsets[o], traceName[j], res.divPpm, fixed.divPpm);
+                    if (LATENCY_PROFILE_DEEP != profiles[p]) {
+                        continue;
+                    }
+                    if (j < TRACE_BURST) {
+                        TEST_CHECK(res.latency < fixed.latency, "%lu Hz %+.0fppm %s: %.1f ms, fixed %.1f ms",
+                                   (unsigned long)rates[r], offsets[o], traceName[j], res.latency, fixed.latency);
+                    }
+                    if (j <= TRACE_BURST) {
+                        TEST_CHECK(0u == res.underruns, "%lu Hz %+.0fppm %s: %lu under-runs", (unsigned long)rates[r],
+                                   offsets[o], traceName[j], (unsigned long)res.underruns);
+                    }
+                }
+                printf("  div %+.0f/%+.0f\n", fixed.divPpm, res.divPpm);
+            }
+        }
+    }
+
+    return testResult("test_jitter_target");
+}
+
+/* [] END OF FILE */
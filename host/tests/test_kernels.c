@@ -0,0 +1,180 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Conversion kernels of writeAudioBuffers() against the per-byte loop they
+* replaced, and a throughput comparison.
+*  - 16-bit: random packets of 44 to 192 frames written across the ring end.
+*    soundBuffer_L/R/I2S have to be byte-identical to what the old loop
+*    (L = hi byte + 128, I2S = hi, lo byte swapped per sample) wrote.
+*  - 24/32-bit: the same against a per-sample model of the upper bytes.
+*  - Host ns per frame of writeAudioBuffers() and of the old loop, and of each
+*    format with 96kHz packets. The target figure comes from PROFILE_CONVERT.
+* Built with AUDIO_WIDE_FORMATS set.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "audio_path.h"
+#include "test.h"
+#include <string.h>
+#include <time.h>
+
+#define PACKETS         (20000u)
+#define BENCH_PACKETS   (200000u)
+
+static uint8 refL[BUFFER_SIZE];
+static uint8 refR[BUFFER_SIZE];
+static uint8 refI2S[I2S_BUFFER_SIZE];
+static uint8 packet[USB_BUF_SIZE] CY_ALIGN(4);
+static uint32 rngState = 7u;
+
+static uint32 rng(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+/*******************************************************************************
+*  The 16-bit per-byte loop of the original main loop, at ring index *in.
+*******************************************************************************/
+static void oldLoop16(const uint8 *src, uint16 size, uint16 *in) {
+    uint16 i;
+
+    for (i = 0u; i < size/(AUDIO_CH*2u); i++) {
+        refL[*in] = src[2u*AUDIO_CH*i + 1u] + 128u;
+        refR[*in] = src[2u*AUDIO_CH*i + 3u] + 128u;
+        refI2S[*in*I2S_DATA_SIZE + 0u] = src[2u*AUDIO_CH*i + 1u];
+        refI2S[*in*I2S_DATA_SIZE + 1u] = src[2u*AUDIO_CH*i + 0u];
+        refI2S[*in*I2S_DATA_SIZE + 2u] = src[2u*AUDIO_CH*i + 3u];
+        refI2S[*in*I2S_DATA_SIZE + 3u] = src[2u*AUDIO_CH*i + 2u];
+        *in = (*in + 1u) % bufferSize;
+    }
+}
+
+/*******************************************************************************
+*  Per-sample model for 24/32-bit packets: the VDAC gets the top byte + 128,
+*  16-bit I2S the top two bytes MSB first.
+*******************************************************************************/
+static void modelWide(const uint8 *src, uint16 size, uint8 bytes, uint16 *in) {
+    uint16 i;
+    uint8 k;
+
+    for (i = 0u; i < size/(AUDIO_CH*bytes); i++) {
+        for (k = 0u; k < AUDIO_CH; k++) {
+            const uint8 *s = &src[(i*AUDIO_CH + k)*bytes];
+
+            ((0u == k) ? refL : refR)[*in] = s[bytes - 1u] + 128u;
+            refI2S[*in*I2S_DATA_SIZE + 2u*k + 0u] = s[bytes - 1u];
+            refI2S[*in*I2S_DATA_SIZE + 2u*k + 1u] = s[bytes - 2u];
+        }
+        *in = (*in + 1u) % bufferSize;
+    }
+}
+
+static uint16 randomPacket(uint8 frameBytes) {
+    uint16 frames = 44u + (uint16)(rng() % 149u);
+    uint16 i;
+
+    if (frames*frameBytes > USB_BUF_SIZE) {
+        frames = USB_BUF_SIZE/frameBytes;
+    }
+    for (i = 0u; i < frames*frameBytes; i++) {
+        packet[i] = (uint8)rng();
+    }
+    return frames*frameBytes;
+}
+
+/* Write a packet and let the DMAs take it at once. */
+static void writePacket(uint16 size, uint8 frameBytes) {
+    TEST_CHECK(0u != writeAudioBuffers(packet, size), "packet dropped");
+    ringRelease(&soundRing, size/frameBytes);
+}
+
+static double seconds(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec*1e-9;
+}
+
+int main(void) {
+    static const uint8 alts[] = {ALT_SETTING_16BIT, ALT_SETTING_24BIT, ALT_SETTING_32BIT};
+    uint16 in;
+    uint16 size;
+    uint32 frames;
+    uint32 i;
+    uint8 a;
+    uint8 bytes;
+    double t;
+    double tNew;
+    double tOld;
+
+    initDMAs();
+    for (a = 0u; a < sizeof(alts); a++) {
+        bytes = (uint8)(alts[a] + 1u);
+        setAudioFormat(alts[a]);
+        setLatencyProfile(LATENCY_PROFILE_DEEP, 48000u);
+        memset(refL, 0, sizeof(refL));
+        memset(refR, 0, sizeof(refR));
+        memset(refI2S, 0, sizeof(refI2S));
+        memset(soundBuffer_L, 0, sizeof(soundBuffer_L));
+        memset(soundBuffer_R, 0, sizeof(soundBuffer_R));
+        memset(soundBuffer_I2S, 0, sizeof(soundBuffer_I2S));
+        in = 0u;
+
+        for (i = 0u; i < PACKETS; i++) {
+            size = randomPacket(AUDIO_CH*bytes);
+            writePacket(size, AUDIO_CH*bytes);
+            if (2u == bytes) {
+                oldLoop16(packet, size, &in);
+            } else {
+                modelWide(packet, size, bytes, &in);
+            }
+        }
+        TEST_CHECK(0 == memcmp(refL, soundBuffer_L, bufferSize), "%u-bit: soundBuffer_L differs", 8u*bytes);
+        TEST_CHECK(0 == memcmp(refR, soundBuffer_R, bufferSize), "%u-bit: soundBuffer_R differs", 8u*bytes);
+        TEST_CHECK(0 == memcmp(refI2S, soundBuffer_I2S, bufferSize*I2S_DATA_SIZE),
+                   "%u-bit: soundBuffer_I2S differs", 8u*bytes);
+    }
+
+    /* Throughput with 48kHz packets. */
+    setAudioFormat(ALT_SETTING_16BIT);
+    setLatencyProfile(LATENCY_PROFILE_DEEP, 48000u);
+    size = 48u*AUDIO_CH*2u;
+    frames = BENCH_PACKETS*48u;
+    in = 0u;
+    t = seconds();
+    for (i = 0u; i < BENCH_PACKETS; i++) {
+        packet[i & 0xFFu] = (uint8)i;
+        writePacket(size, AUDIO_CH*2u);
+    }
+    tNew = seconds() - t;
+    t = seconds();
+    for (i = 0u; i < BENCH_PACKETS; i++) {
+        packet[i & 0xFFu] = (uint8)i;
+        oldLoop16(packet, size, &in);
+    }
+    tOld = seconds() - t;
+    printf("16-bit 48-frame packets: writeAudioBuffers %.2f ns/frame, old loop %.2f ns/frame (host, level meter %s)\n",
+           tNew*1e9/frames, tOld*1e9/frames, (AUDIO_LEVEL_METER) ? "on" : "off");
+
+    /* Per format with 96kHz packets. */
+    frames = BENCH_PACKETS*96u;
+    for (a = 0u; a < sizeof(alts); a++) {
+        bytes = (uint8)(alts[a] + 1u);
+        setAudioFormat(alts[a]);
+        setLatencyProfile(LATENCY_PROFILE_DEEP, 96000u);
+        size = 96u*AUDIO_CH*bytes;
+        t = seconds();
+        for (i = 0u; i < BENCH_PACKETS; i++) {
+            packet[i & 0xFFu] = (uint8)i;
+            writePacket(size, AUDIO_CH*bytes);
+        }
+        tNew = seconds() - t;
+        printf("%2u-bit 96-frame packets: writeAudioBuffers %.2f ns/frame (host)\n", 8u*bytes, tNew*1e9/frames);
+    }
+
+    return testResult("test_kernels");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,270 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* CharLCD framebuffer of lcd_frame.c against a model of the HD44780 behind
+* the PCF8574 backpack: the controller latches the data nibble on each
+* falling edge of E, first in 8-bit mode, and in 4-bit mode after the
+* function set. Every I2C transfer completes only when the test says so, and
+* some are failed: the byte the NAK hit and all after it are lost, which is
+* modeled at an instruction boundary.
+*  - Init: the first step goes out after the CharLCD_INIT_DELAY power up
+*    delay has passed, each next one, or a failed one again, whole
+*    CharLCD_INIT_CMD_DELAY ticks after the previous one started. Some steps
+*    fail. The display ends up in 4-bit mode with two lines, cleared and on,
+*    and nothing is written to it before.
+*  - Changing "44.1kHz" to "48.0kHz" takes two transfers of 13 bytes, the
+*    slave address, the DDRAM address and the character.
+*  - After random prints over the whole frame, with transfers failed at
+*    random, the display shows the frame once lcdService() has caught up.
+*  - Glyphs loaded meanwhile end up in CGRAM, and the cells still match.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "lcd_frame.h"
+#include "tick.h"
+#include "test.h"
+#include <string.h>
+
+#define UPDATES         (20000u)
+
+/* HD44780: DDRAM, CGRAM and the address counter, with the nibble state. */
+static uint8 ddram[0x80u];
+static uint8 cgram[LCD_GLYPH_BYTES];
+static uint8 addr;
+static uint8 inCgram;
+static uint8 mode8 = 1u;
+static uint8 twoLines = 0u;
+static uint8 displayOn = 0u;
+static uint8 upperNibble = 0u;
+static uint8 latched;
+static uint8 port = 0u;
+
+/* Transfer in progress and the traffic so far, slave address included. */
+static uint8 xfer[LCD_PACKET_SIZE];
+static uint8 xferCount;
+static uint8 inFlight = 0u;
+static uint32 transfers = 0u;
+static uint32 bytes = 0u;
+
+/* Init transfers: how many, the tick of the first one and of the last one,
+* and the shortest time between two. */
+static uint32 initTransfers = 0u;
+static uint32 initFirst;
+static uint32 initLast;
+static uint32 initGap = 0xFFFFFFFFu;
+
+/* What has been printed. */
+static char8 frame[LCD_CELLS];
+
+static uint32 rngState = 11u;
+
+static uint32 rng(uint32 n) {
+    rngState = rngState*1664525u + 1013904223u;
+    return (rngState >> 8) % n;
+}
+
+/* HD44780 instruction or data byte. */
+static void execute(uint8 byte, uint8 rs) {
+    if (0u != rs) {
+        TEST_CHECK(0u != displayOn, "data 0x%02X written during init", byte);
+        if (0u != inCgram) {
+            cgram[addr % LCD_GLYPH_BYTES] = byte;
+        } else {
+            ddram[addr & 0x7Fu] = byte;
+        }
+        addr++;
+    } else if (0u != (byte & 0x80u)) {
+        addr = byte & 0x7Fu;
+        inCgram = 0u;
+    } else if (0u != (byte & 0x40u)) {
+        addr = byte & 0x3Fu;
+        inCgram = 1u;
+    } else if (0u != (byte & 0x20u)) {
+        mode8 = (0u != (byte & 0x10u)) ? 1u : 0u;
+        twoLines = (0u != (byte & 0x08u)) ? 1u : 0u;
+    } else if (0u != (byte & 0x08u)) {
+        displayOn = (0u != (byte & 0x04u)) ? 1u : 0u;
+    } else if (CharLCD_CLEAR_DISPLAY == byte) {
+        memset(ddram, ' ', sizeof(ddram));
+        addr = 0u;
+        inCgram = 0u;
+    }
+}
+
+/* PCF8574 output port: P0 RS, P2 E, P4-P7 D4-D7. */
+static void portWrite(uint8 v) {
+    uint8 nibble = port & CharLCD_UPPER_NIB_MASK;
+
+    if ((0u != (port & CharLCD_EH)) && (0u == (v & CharLCD_EH))) {
+        if (0u != mode8) {
+            execute(nibble, port & CharLCD_RSH);
+        } else if (0u == upperNibble) {
+            latched = nibble;
+            upperNibble = 1u;
+        } else {
+            upperNibble = 0u;
+            execute(latched | (nibble >> CharLCD_LOWER_NIB_SHIFT), port & CharLCD_RSH);
+        }
+    }
+    port = v;
+}
+
+static void i2cSink(uint8 address, const uint8 *data, uint8 count) {
+    TEST_CHECK(CharLCD_I2C_SLAVE_ADDR == address, "transfer to 0x%02X", address);
+    TEST_CHECK(count <= sizeof(xfer), "transfer of %u bytes", count);
+    memcpy(xfer, data, count);
+    xferCount = count;
+    inFlight = 1u;
+    transfers++;
+    if (0u == displayOn) {
+        if (0u == initTransfers) {
+            initFirst = tickCount;
+        } else if (tickCount - initLast < initGap) {
+            initGap = tickCount - initLast;
+        }
+        initLast = tickCount;
+        initTransfers++;
+    }
+    bytes += 1u + count;
+}
+
+/* End the transfer in progress. A failed one reaches the port up to an
+* instruction boundary. */
+static void complete(uint8 ok) {
+    uint8 n = xferCount;
+    uint8 i;
+
+    if (0u == inFlight) {
+        return;
+    }
+    if (0u == ok) {
+        n = (0u == xferCount % LCD_INSTRUCTION_BYTES) ?
+            (uint8)(rng(xferCount/LCD_INSTRUCTION_BYTES + 1u)*LCD_INSTRUCTION_BYTES) : 0u;
+    }
+    for (i = 0u; i < n; i++) {
+        portWrite(xfer[i]);
+    }
+    inFlight = 0u;
+    mockI2cComplete(ok);
+}
+
+static void print(uint8 row, uint8 column, const char8 *str) {
+    uint8 c;
+
+    lcdPrint(row, column, str);
+    for (c = column; ('\0' != *str) && (c < LCD_COLUMNS); c++) {
+        frame[row*LCD_COLUMNS + c] = *str++;
+    }
+}
+
+/* Run lcdService() until no transfer is started any more. */
+static void drain(void) {
+    uint16 i;
+
+    for (i = 0u; i < 4u*LCD_CELLS; i++) {
+        lcdService();
+        complete(1u);
+    }
+}
+
+static uint8 shown(void) {
+    uint8 c;
+
+    for (c = 0u; c < LCD_CELLS; c++) {
+        if (ddram[((c < LCD_COLUMNS) ? 0x00u : 0x40u) + c%LCD_COLUMNS] != (uint8)frame[c]) {
+            return 0u;
+        }
+    }
+    return 1u;
+}
+
+int main(void) {
+    static uint8 glyphs[LCD_GLYPH_BYTES];
+    char8 str[8];
+    uint32 x0;
+    uint32 b0;
+    uint32 k;
+    uint16 i;
+    uint8 n;
+
+    memset(ddram, '?', sizeof(ddram));
+    memset(frame, ' ', sizeof(frame));
+    mockI2cSink = &i2cSink;
+    mockI2cManual = 1u;
+    initTick();
+    initLcd();
+
+    print(0u, 0u, "Audio ON");
+    print(1u, 0u, "44.1kHz");
+    for (k = 0u; k < 200u; k++) {
+        mockSysTick();
+        for (i = 0u; i < 4u; i++) {
+            lcdService();
+            complete((0u != rng(4u)) ? 1u : 0u);
+        }
+    }
+    drain();
+    printf("init: %lu transfers, first at %lums, at least %lums apart\n", (unsigned long)initTransfers,
+           (unsigned long)initFirst, (unsigned long)initGap);
+    TEST_CHECK(initFirst > CharLCD_INIT_DELAY, "first init step at %lums", (unsigned long)initFirst);
+    TEST_CHECK(initGap > CharLCD_INIT_CMD_DELAY, "init steps %lums apart", (unsigned long)initGap);
+    TEST_CHECK((0u == mode8) && (0u != twoLines) && (0u != displayOn), "display not up: 8-bit %u, 2 lines %u, on %u",
+               mode8, twoLines, displayOn);
+    TEST_CHECK(shown(), "initial frame not shown");
+
+    /* Only the changed cells are sent, the cursor moved to each. */
+    x0 = transfers;
+    b0 = bytes;
+    print(1u, 0u, "48.0kHz");
+    drain();
+    printf("\"44.1kHz\" -> \"48.0kHz\": %lu transfers, %lu bytes\n", (unsigned long)(transfers - x0),
+           (unsigned long)(bytes - b0));
+    TEST_CHECK(shown(), "48.0kHz not shown");
+    TEST_CHECK((2u == transfers - x0) && (2u*(1u + 2u*LCD_INSTRUCTION_BYTES) == bytes - b0),
+               "48.0kHz took %lu transfers, %lu bytes", (unsigned long)(transfers - x0), (unsigned long)(bytes - b0));
+
+    /* Random prints, one transfer in ten failed. */
+    for (k = 0u; k < UPDATES; k++) {
+        n = (uint8)(1u + rng(6u));
+        for (i = 0u; i < n; i++) {
+            str[i] = (char8)('A' + rng(26u));
+        }
+        str[n] = '\0';
+        print((uint8)rng(LCD_ROWS), (uint8)rng(LCD_COLUMNS), str);
+        for (i = (uint16)rng(5u); i > 0u; i--) {
+            lcdService();
+            if (0u == rng(3u)) {
+                complete((0u != rng(10u)) ? 1u : 0u);
+            }
+        }
+    }
+    drain();
+    printf("%u random prints: %lu transfers\n", UPDATES, (unsigned long)transfers);
+    TEST_CHECK(shown(), "frame not shown after random prints");
+
+    /* Glyphs, loaded while cells change. */
+    for (i = 0u; i < LCD_GLYPH_BYTES; i++) {
+        glyphs[i] = (uint8)(i*7u + 3u) & 0x1Fu;
+    }
+    lcdLoadGlyphs(glyphs);
+    str[0] = LCD_GLYPH(3u);
+    str[1] = LCD_GLYPH(0u);
+    str[2] = '\0';
+    print(1u, 14u, str);
+    for (i = 0u; i < 2000u; i++) {
+        lcdService();
+        if (0u == rng(3u)) {
+            complete((0u != rng(10u)) ? 1u : 0u);
+        }
+        if (0u == i % 50u) {
+            print(0u, (uint8)rng(LCD_COLUMNS), "Z");
+        }
+    }
+    drain();
+    TEST_CHECK(0 == memcmp(glyphs, cgram, sizeof(glyphs)), "glyphs not loaded");
+    TEST_CHECK(shown(), "frame not shown after the glyphs");
+
+    return testResult("test_lcd_frame");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,122 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Stage profiling of profiler.c, built with PROFILING set and mockCycles() as
+* its cycle counter, and the profile page of telemetry.c.
+*  - Statistics: runs of known cycles given to profileRecord() come out of
+*    profileExport() as min/avg/max/count of their stage, all 0 for a stage
+*    that has not run, and the export restarts them.
+*  - Markers: the receive stage records PROFILE_EP_READ and PROFILE_CONVERT
+*    once per packet. The counter advances CONVERT_CYCLES at each barrier,
+*    i.e. where the conversion publishes the packet, and starts just below
+*    the 32-bit wrap, so each conversion takes CONVERT_CYCLES and each read
+*    none.
+*  - Page: TELEMETRY_PROFILE_PAGE requested over EZI2C is served as the
+*    PROFILE_STAT of each stage, with pageReady set and the request cleared,
+*    and restarts the statistics. The stages fit the page window.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "audio_path.h"
+#include "profiler.h"
+#include "telemetry.h"
+#include "test.h"
+#include <string.h>
+
+#define PACKETS         (16u)     /* Fit the DEEP ring. */
+#define FRAMES          (48u)
+#define CONVERT_CYCLES  (1000u)
+
+static uint32 barriers;
+
+static void advance(void) {
+    mockCycleCount += CONVERT_CYCLES;
+    barriers++;
+}
+
+int main(void) {
+    static const uint32 runs[] = {700u, 300u, 0xFFFFFFF0u, 1000u};
+    static uint8 packet[FRAMES*4u];
+    PROFILE_STAT stat[PROFILE_STAGES];
+    const PROFILE_STAT *page = (const PROFILE_STAT *)EZI2C_buf.page;
+    uint32 i;
+    uint8 s;
+
+    TEST_CHECK(sizeof(stat) <= sizeof(EZI2C_buf.page), "%u stages take %u bytes, the page window %u",
+               PROFILE_STAGES, (unsigned)sizeof(stat), (unsigned)sizeof(EZI2C_buf.page));
+
+    initProfiler();
+    initTelemetry();
+
+    /* Statistics. */
+    for (i = 0u; i < sizeof(runs)/sizeof(runs[0]); i++) {
+        profileRecord(PROFILE_SERVO, runs[i]);
+    }
+    profileRecord(PROFILE_LCD, 5u);
+    profileExport(stat);
+    TEST_CHECK((300u == stat[PROFILE_SERVO].min) && (0xFFFFFFF0u == stat[PROFILE_SERVO].max) &&
+               (4u == stat[PROFILE_SERVO].count) && (0x400001F0u == stat[PROFILE_SERVO].avg),
+               "servo: min %lu avg %lu max %lu count %lu", (unsigned long)stat[PROFILE_SERVO].min,
+               (unsigned long)stat[PROFILE_SERVO].avg, (unsigned long)stat[PROFILE_SERVO].max,
+               (unsigned long)stat[PROFILE_SERVO].count);
+    TEST_CHECK((5u == stat[PROFILE_LCD].min) && (5u == stat[PROFILE_LCD].avg) && (5u == stat[PROFILE_LCD].max) &&
+               (1u == stat[PROFILE_LCD].count), "lcd: a single run of 5 cycles exported as %lu/%lu/%lu",
+               (unsigned long)stat[PROFILE_LCD].min, (unsigned long)stat[PROFILE_LCD].avg,
+               (unsigned long)stat[PROFILE_LCD].max);
+    for (s = 0u; s < PROFILE_STAGES; s++) {
+        TEST_CHECK((PROFILE_SERVO == s) || (PROFILE_LCD == s) ||
+                   ((0u == stat[s].min) && (0u == stat[s].avg) && (0u == stat[s].max) && (0u == stat[s].count)),
+                   "stage %u has not run but exports %lu runs", s, (unsigned long)stat[s].count);
+    }
+    profileExport(stat);
+    TEST_CHECK((0u == stat[PROFILE_SERVO].count) && (0u == stat[PROFILE_SERVO].max),
+               "export did not restart the statistics");
+
+    /* Markers. */
+    initDMAs();
+    setAudioFormat(ALT_SETTING_16BIT);
+    setLatencyProfile(LATENCY_PROFILE_DEEP, 48000u);
+    enableOutPacket();
+    memset(packet, 0x55, sizeof(packet));
+    mockCycleCount = 0xFFFFFFFFu - PACKETS*CONVERT_CYCLES/2u;
+    mockBarrierHook = &advance;
+    for (i = 0u; i < PACKETS; i++) {
+        (void)mockUsbReceive(OUT_EP_NUM, packet, sizeof(packet));
+        receiveOutPacket();
+    }
+    mockBarrierHook = NULL;
+    TEST_CHECK(PACKETS == rxPacketCount, "%u packets received of %u", rxPacketCount, PACKETS);
+
+    /* Page. */
+    EZI2C_buf.historyPage = TELEMETRY_PROFILE_PAGE;
+    serveHistoryPage();
+    TEST_CHECK((TELEMETRY_PROFILE_PAGE == EZI2C_buf.pageReady) && (TELEMETRY_NO_PAGE == EZI2C_buf.historyPage),
+               "profile page: pageReady %02X, historyPage %02X", EZI2C_buf.pageReady, EZI2C_buf.historyPage);
+    printf("per packet: endpoint read %lu..%lu cycles, conversion %lu..%lu cycles, %lu barriers\n",
+           (unsigned long)page[PROFILE_EP_READ].min, (unsigned long)page[PROFILE_EP_READ].max,
+           (unsigned long)page[PROFILE_CONVERT].min, (unsigned long)page[PROFILE_CONVERT].max,
+           (unsigned long)barriers);
+    TEST_CHECK((PACKETS == page[PROFILE_EP_READ].count) && (PACKETS == page[PROFILE_CONVERT].count),
+               "%lu endpoint reads and %lu conversions recorded of %u packets",
+               (unsigned long)page[PROFILE_EP_READ].count, (unsigned long)page[PROFILE_CONVERT].count, PACKETS);
+    TEST_CHECK((PACKETS == barriers) && (CONVERT_CYCLES == page[PROFILE_CONVERT].min) &&
+               (CONVERT_CYCLES == page[PROFILE_CONVERT].avg) && (CONVERT_CYCLES == page[PROFILE_CONVERT].max) &&
+               (0u == page[PROFILE_EP_READ].max),
+               "conversion %lu/%lu/%lu cycles, endpoint read up to %lu, for %lu barriers of %u cycles",
+               (unsigned long)page[PROFILE_CONVERT].min, (unsigned long)page[PROFILE_CONVERT].avg,
+               (unsigned long)page[PROFILE_CONVERT].max, (unsigned long)page[PROFILE_EP_READ].max,
+               (unsigned long)barriers, CONVERT_CYCLES);
+    for (s = 0u; s < PROFILE_STAGES; s++) {
+        TEST_CHECK((PROFILE_EP_READ == s) || (PROFILE_CONVERT == s) || (0u == page[s].count),
+                   "stage %u: %lu runs on the page", s, (unsigned long)page[s].count);
+    }
+
+    EZI2C_buf.historyPage = TELEMETRY_PROFILE_PAGE;
+    serveHistoryPage();
+    TEST_CHECK((0u == page[PROFILE_CONVERT].count) && (0u == page[PROFILE_CONVERT].max),
+               "profile page did not restart the statistics");
+
+    return testResult("test_profiler");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,124 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Zero-copy receive with automatic endpoint DMA (built with USBFS_EP_MM set to
+* USBFS__EP_DMAAUTO).
+*  - A packet arriving while rawPacket is still being converted is refused by
+*    the disabled endpoint, so the endpoint DMA never writes the slot in use.
+*  - receiveOutPacket() re-arms the endpoint on rawPacket after converting,
+*    and a stream of random packets reaches the sound buffers in order.
+*  - Host time of the receive stage per largest 16-bit packet, and of the copy
+*    the manual DMA path adds. On the target the copy is an endpoint DMA the
+*    CPU waits for, which PROFILE_EP_READ measures.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "audio_path.h"
+#include "test.h"
+#include <string.h>
+#include <time.h>
+
+#define PACKETS         (5000u)
+#define BENCH_PACKETS   (100000u)
+
+static uint8 packet[USB_BUF_SIZE] CY_ALIGN(4);
+static uint8 copy[USB_BUF_SIZE] CY_ALIGN(4);
+static uint32 rngState = 3u;
+
+static uint32 rng(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static void randomPacket(uint16 size) {
+    uint16 i;
+
+    for (i = 0u; i < size; i++) {
+        packet[i] = (uint8)rng();
+    }
+}
+
+/* Whether the frames of packet (16-bit) are at the ring position before head. */
+static uint8 packetInRing(uint16 frames) {
+    uint16 idx = (uint16)(soundRing.head - frames) & soundRing.mask;
+    uint16 i;
+
+    for (i = 0u; i < frames; i++, idx = (idx + 1u) & soundRing.mask) {
+        if ((soundBuffer_I2S[idx*I2S_DATA_SIZE] != packet[4u*i + 1u]) ||
+            (soundBuffer_I2S[idx*I2S_DATA_SIZE + 2u] != packet[4u*i + 3u])) {
+            return 0u;
+        }
+    }
+    return 1u;
+}
+
+static double seconds(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec*1e-9;
+}
+
+int main(void) {
+    const uint8 *data;
+    uint16 size;
+    uint32 i;
+    double t;
+    double tRx;
+    double tCopy;
+
+    initDMAs();
+    setAudioFormat(ALT_SETTING_16BIT);
+    setLatencyProfile(LATENCY_PROFILE_DEEP, 48000u);
+    enableOutPacket();
+
+    /* The endpoint stays disabled while the packet is used in place. */
+    randomPacket(192u);
+    TEST_CHECK(1u == mockUsbReceive(OUT_EP_NUM, packet, 192u), "armed endpoint refused a packet");
+    data = readOutPacket(&size);
+    TEST_CHECK((data == rawPacket) && (192u == size), "packet not in rawPacket");
+    memset(copy, 0xA5, sizeof(copy));
+    TEST_CHECK(0u == mockUsbReceive(OUT_EP_NUM, copy, 192u), "endpoint accepted a packet over the one in use");
+    TEST_CHECK(0 == memcmp(rawPacket, packet, 192u), "rawPacket overwritten while in use");
+    TEST_CHECK(1u == writeAudioBuffers(data, size), "packet dropped");
+    TEST_CHECK(packetInRing(48u), "packet not converted");
+    enableOutPacket();
+    ringRelease(&soundRing, 48u);
+
+    /* Full receive stage over a stream of packets. */
+    for (i = 0u; i < PACKETS; i++) {
+        size = (uint16)(4u*(44u + rng() % 5u));
+        randomPacket(size);
+        TEST_CHECK(1u == mockUsbReceive(OUT_EP_NUM, packet, size), "packet %lu refused", (unsigned long)i);
+        receiveOutPacket();
+        TEST_CHECK(USBFS_OUT_BUFFER_EMPTY == USBFS_GetEPState(OUT_EP_NUM), "endpoint not re-armed");
+        TEST_CHECK(packetInRing(size/4u), "packet %lu not in the ring", (unsigned long)i);
+        ringRelease(&soundRing, size/4u);
+    }
+
+    /* Receive stage cost of the largest packet, and the copy of the manual DMA path. */
+    setLatencyProfile(LATENCY_PROFILE_DEEP, MAX_FRAMES_16BIT*1000u);
+    size = MAX_FRAMES_16BIT*AUDIO_CH*2u;
+    randomPacket(size);
+    tRx = 0.0;
+    tCopy = 0.0;
+    for (i = 0u; i < BENCH_PACKETS; i++) {
+        (void)mockUsbReceive(OUT_EP_NUM, packet, size);
+        t = seconds();
+        receiveOutPacket();
+        tRx += seconds() - t;
+        ringRelease(&soundRing, MAX_FRAMES_16BIT);
+
+        t = seconds();
+        memcpy(copy, rawPacket, size);
+        tCopy += seconds() - t;
+    }
+    printf("%u-frame 16-bit packet: receive stage %.0f ns in place, the manual path copy adds %.0f ns (host)\n",
+           MAX_FRAMES_16BIT, tRx*1e9/BENCH_PACKETS, tCopy*1e9/BENCH_PACKETS);
+
+    return testResult("test_raw_packet");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,175 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* AUDIO_RING of audio_ring.h between a producer writing packets frame by
+* frame, as the receive stage does, and a consumer releasing whole chunks, as
+* VdacDmaDone does. The consumer is a simulated ISR raised at each chunk end
+* of DMAs running 25% slower or faster than the producer. It preempts the
+* producer at a random frame after the chunk end, or at the latest inside
+* the next ringPublish(). Every ring size from 2^2 to 2^15 frames is run for
+* RING_TURNS turns from count 0 and from just below the 16-bit wrap. Each
+* frame holds its sequence number.
+*  - Order and loss: the consumer reads the frames the producer accepted,
+*    each once and in order. A packet is dropped only when ringSpace() says
+*    it does not fit, and then no frame of it is written.
+*  - ringFill() + ringSpace() is the ring size, ringFill() never exceeds it,
+*    and ringAhead() of the tail position is the fill level below the size.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "audio_ring.h"
+#include "test.h"
+#include <string.h>
+
+#define RING_MAX_LOG2   (15u)
+#define RING_CHUNKS     (4u)
+#define RING_TURNS      (256u)
+
+typedef struct {
+    uint32 accepted;        /* Frames written and published. */
+    uint32 consumed;
+    uint32 dropped;         /* Packets without room. */
+    uint32 lost;            /* Frames read out of sequence. */
+    uint32 bad;             /* Inconsistent fill, space or ahead. */
+    uint32 underruns;       /* Chunk ends with less than a chunk filled. */
+    uint32 preempted;       /* Consumer runs inside ringPublish(). */
+} RING_RESULT;
+
+static uint32 buf[1u << RING_MAX_LOG2];
+static AUDIO_RING ring;
+static uint16 chunk;
+static uint32 expected;     /* Sequence number the consumer reads next. */
+static double rate;         /* DMA frames per frame written. */
+static double dmaFrames;    /* Played since the last chunk end. */
+static uint8 inIsr;
+static uint8 inPublish;
+static RING_RESULT *result;
+static uint32 rngState = 1u;
+
+static uint32 rng(uint32 n) {
+    rngState = rngState*1664525u + 1013904223u;
+    return (rngState >> 8) % n;
+}
+
+/* The chunk end ISR: release a chunk when it is filled. */
+static void consumer(void) {
+    uint16 idx;
+    uint16 i;
+
+    if (ringFill(&ring) < chunk) {
+        result->underruns++;
+        return;
+    }
+    result->preempted += inPublish;
+    idx = ringTailIndex(&ring);
+    for (i = 0u; i < chunk; i++) {
+        result->lost += (buf[(idx + i) & ring.mask] == expected) ? 0u : 1u;
+        expected++;
+    }
+    ringRelease(&ring, chunk);
+    result->consumed += chunk;
+}
+
+/* The DMAs play frames at rate: raise the chunk ends due, at this point with
+ * a probability of 1/(chunk + 1) unless always, so that one in a few is
+ * raised inside ringPublish(). */
+static void preempt(double frames, uint8 always) {
+    dmaFrames += frames*rate;
+    if (inIsr || (!always && (0u != rng(chunk + 1u)))) {
+        return;
+    }
+    inIsr = 1u;
+    while (dmaFrames >= chunk) {
+        dmaFrames -= chunk;
+        consumer();
+    }
+    inIsr = 0u;
+}
+
+/* ringPublish() and ringRelease() barriers. */
+static void barrier(void) {
+    preempt(0.0, 1u);
+}
+
+static void check(void) {
+    uint16 fill = ringFill(&ring);
+    uint16 size = ring.mask + 1u;
+
+    result->bad += ((fill <= size) && ((uint16)(fill + ringSpace(&ring)) == size)) ? 0u : 1u;
+    result->bad += ((fill >= size) || (ringAhead(&ring, ringTailIndex(&ring)) == fill)) ? 0u : 1u;
+}
+
+static void runRing(uint8 sizeLog2, uint16 start, RING_RESULT *res) {
+    uint32 seq = 0u;
+    uint16 size = 1u << sizeLog2;
+    uint16 head;
+    uint16 n;
+    uint16 i;
+
+    memset(res, 0, sizeof(*res));
+    result = res;
+    ringInit(&ring, size);
+    ring.head = start;
+    ring.tail = start;
+    chunk = size/RING_CHUNKS;
+    expected = 0u;
+    dmaFrames = 0.0;
+
+    while (res->accepted < RING_TURNS*(uint32)size) {
+        /* The DMAs run 25% slow and fast by turns of the ring, so that it
+         * fills up and runs dry. Packets of up to half of the ring, one chunk
+         * on average. */
+        rate = (0u != (res->accepted/size & 1u)) ? 1.25 : 0.75;
+        n = (uint16)(1u + rng(2u*chunk));
+        if (n > ringSpace(&ring)) {
+            res->dropped++;
+            preempt(n, 0u);
+        } else {
+            head = ringHeadIndex(&ring);
+            for (i = 0u; i < n; i++) {
+                buf[(head + i) & ring.mask] = seq + i;
+                preempt(1.0, 0u);
+            }
+            seq += n;
+            res->accepted += n;
+            inPublish = 1u;
+            ringPublish(&ring, n);
+            inPublish = 0u;
+        }
+        check();
+    }
+
+    /* Drain. */
+    inIsr = 1u;
+    while (ringFill(&ring) >= chunk) {
+        consumer();
+    }
+    inIsr = 0u;
+    res->bad += (res->accepted - res->consumed == ringFill(&ring)) ? 0u : 1u;
+}
+
+int main(void) {
+    static const uint16 starts[] = {0u, 0xFF00u};
+    RING_RESULT res;
+    uint8 sizeLog2;
+    uint8 i;
+
+    mockBarrierHook = &barrier;
+    for (sizeLog2 = 2u; sizeLog2 <= RING_MAX_LOG2; sizeLog2++) {
+        for (i = 0u; i < sizeof(starts)/sizeof(starts[0]); i++) {
+            runRing(sizeLog2, starts[i], &res);
+            TEST_CHECK((0u == res.lost) && (0u == res.bad),
+                       "2^%u frames from %04X: %lu frames out of sequence, %lu inconsistent levels", sizeLog2,
+                       starts[i], (unsigned long)res.lost, (unsigned long)res.bad);
+            TEST_CHECK((0u != res.dropped) && (0u != res.underruns) && (0u != res.preempted),
+                       "2^%u frames from %04X: %lu drops, %lu under-runs, %lu releases in ringPublish()", sizeLog2,
+                       starts[i], (unsigned long)res.dropped, (unsigned long)res.underruns,
+                       (unsigned long)res.preempted);
+        }
+    }
+    mockBarrierHook = NULL;
+
+    return testResult("test_ring");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,156 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Fixed-point servo against the floating-point servo it replaced. Every step
+* starts both from the same state:
+*  - servoUpdateAverage() against distAverage*(1-w) + dist*w, w = fs/100000*0.01,
+*    over a random walk of the buffered data size;
+*  - servoAdjust() against the three band divAdj update in double precision,
+*    with random BitClk offsets up to +/-2% and random averaged buffer fill.
+*    The gains are the float servo's 0.8, 0.4 and 0.1 compounded over the
+*    adjust intervals of a gate, as the Q8 SERVO_GAIN_xxx give them.
+* Band selection and clockAdjust have to match, and the divider may differ by
+* the rounding of the integer terms.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "clock_servo.h"
+#include "test.h"
+#include <math.h>
+
+#define STEPS           (200000u)
+#define DIV_TOLERANCE   (2.0)       /* Divider LSBs. */
+#define AVG_TOLERANCE   (0.01)      /* Frames. */
+
+static uint32 rngState = 1u;
+
+static uint32 rng(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+/* Uniform in [-1, 1). */
+static double rngUnit(void) {
+    return (double)rng()/2147483648.0 - 1.0;
+}
+
+/*******************************************************************************
+*  Floating-point reference of one adjustment step. Returns the band and sets
+*  *divAdj and *clockAdjust.
+*******************************************************************************/
+/* Float servo gain g compounded over the adjust intervals of a gate. */
+static double gateGain(double g) {
+    return 1.0 - pow(1.0 - g, (double)BITCLK_GATE/adjustInterval);
+}
+
+static uint8 refAdjust(double fs, double initialDiv, double *divAdj, double distAverage, double half,
+                       double bitClkFreq, int16 *clockAdjust) {
+    double d = fabs((bitClkFreq - fs)/fs);
+    double tic = fabs(distAverage - half)*30.0;
+
+    if (d > 1/100.0) {
+        *divAdj += (initialDiv + *divAdj)*(fs/bitClkFreq - 1.0)*SERVO_GAIN_COARSE/256.0;
+        return SERVO_BAND_COARSE;
+    }
+    if (d > 1/150.0) {
+        *divAdj += (initialDiv + *divAdj)*(fs/bitClkFreq - 1.0)*SERVO_GAIN_FINE/256.0;
+        return SERVO_BAND_FINE;
+    }
+    *divAdj += (initialDiv + *divAdj)*(fs/bitClkFreq - 1.0)*SERVO_GAIN_PRECISE/256.0;
+    *clockAdjust = 0;
+    if (distAverage > half + UpperAdjustRange) {
+        *divAdj += tic;
+        *clockAdjust = UpperAdjustRange;
+    }
+    if (distAverage < half + LowerAdjustRange) {
+        *divAdj -= tic;
+        *clockAdjust = LowerAdjustRange;
+    }
+    return SERVO_BAND_PRECISE;
+}
+
+/* Whether x is within a fixed-point rounding step of a decision threshold. */
+static int nearThreshold(double x, double threshold, double step) {
+    return fabs(x - threshold) <= step;
+}
+
+int main(void) {
+    static const uint32 rates[] = {44100u, 48000u, 88200u, 96000u};
+    CLOCK_SERVO s = {0};
+    double worstDiv = 0.0;
+    double worstAvg = 0.0;
+    uint32 compared = 0u;
+    uint32 r;
+    uint32 i;
+
+    TEST_CHECK(fabs(SERVO_GAIN_COARSE/256.0 - gateGain(0.8)) < 1/256.0, "coarse gain");
+    TEST_CHECK(fabs(SERVO_GAIN_FINE/256.0 - gateGain(0.4)) < 1/256.0, "fine gain");
+    TEST_CHECK(fabs(SERVO_GAIN_PRECISE/256.0 - gateGain(0.1)) < 1/256.0, "precise gain");
+
+    for (r = 0u; r < sizeof(rates)/sizeof(rates[0]); r++) {
+        double fs = rates[r];
+        double w = fs/100000.0*0.01;
+        double avg;
+        uint16 dist = (uint16)(bufferSize/2u);
+
+        servoSetRate(&s, rates[r]);
+        servoResetAverage(&s, dist);
+        avg = dist;
+
+        /* Moving average. */
+        for (i = 0u; i < STEPS; i++) {
+            int32 next = (int32)dist + (int32)(rng() % 97u) - 48;
+
+            dist = (uint16)((next < 0) ? 0 : ((next >= (int32)bufferSize) ? (int32)bufferSize - 1 : next));
+            servoUpdateAverage(&s, dist);
+            avg = avg*(1.0 - w) + dist*w;
+            worstAvg = fmax(worstAvg, fabs(s.distAverage/65536.0 - avg));
+        }
+        TEST_CHECK(worstAvg <= AVG_TOLERANCE, "%lu Hz: distAverage off by %.4f frames",
+                   (unsigned long)rates[r], worstAvg);
+
+        /* Adjustment steps. */
+        for (i = 0u; i < STEPS; i++) {
+            double ppm = rngUnit()*20000.0*((0u == (i & 3u)) ? 1.0 : 0.01);
+            uint32 freq = (uint32)llround(fs*(1.0 + ppm*1e-6)*256.0);
+            double bitClk = freq/256.0;
+            double half = s.target;
+            double refAdj = s.divAdj;
+            double avgFrames;
+            int16 refClock = s.clockAdjust;
+            uint8 band;
+
+            s.distAverage = (uint32)(half*65536.0 + rngUnit()*2.5*UpperAdjustRange*65536.0);
+            avgFrames = s.distAverage/65536.0;
+            s.divAdj = (int32)(rngUnit()*0.02*s.initialDiv);
+            refAdj = s.divAdj;
+
+            band = refAdjust(fs, s.initialDiv, &refAdj, avgFrames, half, bitClk, &refClock);
+            (void)servoAdjust(&s, freq, 1u);
+
+            /* Ties at a band or range edge can go either way. */
+            if (nearThreshold(fabs(bitClk - fs)/fs, 1/100.0, 1e-8) ||
+                nearThreshold(fabs(bitClk - fs)/fs, 1/150.0, 1e-8) ||
+                nearThreshold(avgFrames, half + UpperAdjustRange, 1/65536.0) ||
+                nearThreshold(avgFrames, half + LowerAdjustRange, 1/65536.0)) {
+                continue;
+            }
+            compared++;
+            TEST_CHECK(band == s.band, "%lu Hz step %lu: band %u, reference %u",
+                       (unsigned long)rates[r], (unsigned long)i, s.band, band);
+            TEST_CHECK(refClock == s.clockAdjust, "%lu Hz step %lu: clockAdjust %d, reference %d",
+                       (unsigned long)rates[r], (unsigned long)i, s.clockAdjust, refClock);
+            worstDiv = fmax(worstDiv, fabs((double)s.div - (s.initialDiv + refAdj)));
+        }
+    }
+
+    TEST_CHECK(worstDiv <= DIV_TOLERANCE, "divider off by %.2f LSBs", worstDiv);
+    printf("%lu adjust steps compared, divider within %.2f LSBs, distAverage within %.4f frames\n",
+           (unsigned long)compared, worstDiv, worstAvg);
+
+    return testResult("test_servo_fixed");
+}
+
+/* [] END OF FILE */
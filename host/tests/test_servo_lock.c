@@ -0,0 +1,93 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Lock time of the three band servoAdjust() loop with the gate measurement.
+* FreqCapt is fed the BitClk_Counter counts of the FracDiv output every 1ms
+* and the main loop step runs every adjustInterval packets, as in main.c, with
+* the buffered data size held at the target. The source clock is off by a
+* fixed offset, and the servo starts cold at each rate. The lock time is the
+* time from which the BitClk stays within LOCK_PPM of fs.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "clock_servo.h"
+#include "test.h"
+#include <math.h>
+#include <string.h>
+
+#define LOCK_PPM        (10.0)
+#define LOCK_LIMIT_MS   (3000u)
+#define RUN_MS          (60000u)
+
+/* FracDiv output [Hz] for divider value div and source offset ppm. */
+static double fracDivOut(uint32 div, double ppm) {
+    return DIVIDER_SOURCE_FREQ*(1.0 + ppm*1e-6)*((double)div/div_MAX);
+}
+
+/*******************************************************************************
+*  Run the loop at fs with offset ppm. Returns the lock time [ms], or RUN_MS
+*  when the BitClk never stays within LOCK_PPM.
+*******************************************************************************/
+static uint32 lockTime(uint32 fs, double ppm) {
+    CLOCK_SERVO s;
+    double count = 0.0;
+    uint32 seq = 0u;
+    uint32 lastSeq = 0u;
+    uint32 lock = RUN_MS;
+    uint32 freq;
+    uint32 t;
+
+    memset(&s, 0, sizeof(s));
+    servoSetRate(&s, fs);
+    servoResetAverage(&s, servoStartLevel(&s));
+    restartBitClkMeasure();
+
+    for (t = 1u; t <= RUN_MS; t++) {
+        /* USB SOF: capture the counts of the last ms. */
+        count += fracDivOut(s.div, ppm)/1000.0;
+        mockBitClkCount = (uint32)count;
+        count -= mockBitClkCount;
+        FreqCapt();
+
+        if (0u == t % adjustInterval) {
+            freq = getBitClkFrequency(&seq);
+            (void)servoAdjust(&s, freq, seq != lastSeq);
+            lastSeq = seq;
+        }
+
+        if (fabs(fracDivOut(s.div, ppm)/I2S_CLOCK_FACTOR/fs - 1.0)*1e6 < LOCK_PPM) {
+            lock = (RUN_MS == lock) ? t : lock;
+        } else {
+            lock = RUN_MS;
+        }
+    }
+
+    return lock;
+}
+
+int main(void) {
+    static const uint32 rates[] = {44100u, 48000u, 88200u, 96000u};
+    static const double offsets[] = {300.0, -3000.0, 8000.0, -12000.0};
+    uint32 worst = 0u;
+    uint32 lock;
+    uint8 o;
+    uint8 r;
+
+    printf("lock time [s] at 44.1/48/88.2/96kHz\n");
+    for (o = 0u; o < sizeof(offsets)/sizeof(offsets[0]); o++) {
+        printf("  %+7.0fppm:", offsets[o]);
+        for (r = 0u; r < sizeof(rates)/sizeof(rates[0]); r++) {
+            lock = lockTime(rates[r], offsets[o]);
+            worst = (lock > worst) ? lock : worst;
+            printf(" %6.2f", lock/1000.0);
+            TEST_CHECK(lock <= LOCK_LIMIT_MS, "%lu Hz %+.0fppm: locked after %lu ms",
+                       (unsigned long)rates[r], offsets[o], (unsigned long)lock);
+        }
+        printf("\n");
+    }
+    printf("worst lock time %.2f s\n", worst/1000.0);
+
+    return testResult("test_servo_lock");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,207 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* PI clock recovery loop servoControl() against the three band servoAdjust().
+* The host sends a packet every 1ms, taken in by the receive stage up to
+* 0.25ms late, and the DMAs drain the ring at the FracDiv rate from the
+* moment the start level is reached. FreqCapt counts the BitClk every SOF and
+* each controller is stepped as in main.c, from a cold start. The source
+* clock is off by a fixed offset, in two cases also drifting and wandering
+* with a 60s period. Each run lasts RUN_MS; the statistics cover the last
+* two thirds of it.
+*  - Lock: the BitClk within LOCK_PPM of fs for 10s. The PI loop has to lock
+*    within PI_LOCK_RATIO times the three band lock time.
+*  - The PI loop has to hold the fill level mean within PI_FILL_FRAMES of the
+*    target, and no further from it than the three band servo, within a
+*    frame. Its BitClk may wander at most PI_WANDER_PPM more, in standard
+*    deviation.
+*  - Neither controller may run the ring dry or full once the statistics
+*    start. Before, a cold start with a large offset may.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "clock_servo.h"
+#include "test.h"
+#include <math.h>
+#include <string.h>
+
+#define RUN_MS          (300000u)
+#define LOCK_PPM        (10.0)
+#define LOCK_HOLD_MS    (10000u)
+#define PI_LOCK_RATIO   (10.0)
+#define PI_FILL_FRAMES  (0.5*fs/1000.0)
+#define PI_WANDER_PPM   (1.5)
+#define DELAY_MS        (0.25)
+
+typedef struct {
+    uint32 fs;
+    double ppm;             /* Source clock offset at the start. */
+    double drift;           /* [ppm/s] */
+    double wobble;          /* Amplitude of the 60s wander [ppm]. */
+} PI_CASE;
+
+typedef struct {
+    double lock;            /* [s], negative when never locked. */
+    double ppmStd;
+    double fillMean;        /* From the target [frames]. */
+    double fillStd;
+    uint8 ok;               /* The ring never ran dry or full later on. */
+} PI_RESULT;
+
+static uint32 rngState = 1u;
+
+static double urand(void) {
+    rngState = rngState*1664525u + 1013904223u;
+    return (rngState >> 8)/16777216.0;
+}
+
+/* FracDiv output [frames/s] for divider value div and source offset ppm. */
+static double frameRate(uint32 div, double ppm) {
+    return DIVIDER_SOURCE_FREQ*(1.0 + ppm*1e-6)*((double)div/div_MAX)/I2S_CLOCK_FACTOR;
+}
+
+static void runCase(const PI_CASE *c, uint8 pi, PI_RESULT *res) {
+    CLOCK_SERVO s;
+    double fill = 0.0;
+    double acc = 0.0;
+    double count = 0.0;
+    double ppm;
+    double rate;
+    double err;
+    double f;
+    double sumP = 0.0;
+    double sumP2 = 0.0;
+    double sumF = 0.0;
+    double sumF2 = 0.0;
+    uint32 n = 0u;
+    uint32 okSince = RUN_MS;
+    uint32 seq = 0u;
+    uint32 lastSeq = 0u;
+    uint32 servoTime = 0u;
+    uint32 freq;
+    uint32 t;
+    uint16 frames;
+    uint16 dist;
+    uint8 running = 0u;
+
+    memset(&s, 0, sizeof(s));
+    memset(res, 0, sizeof(*res));
+    res->lock = -1.0;
+    res->ok = 1u;
+    rngState = 1u;
+    setLatencyProfile(LATENCY_PROFILE_DEEP, c->fs);
+    servoSetRate(&s, c->fs);
+    servoResetAverage(&s, 0u);
+
+    for (t = 0u; t < RUN_MS; t++) {
+        ppm = c->ppm + c->drift*t/1000.0 + c->wobble*sin(2.0*M_PI*t/60000.0);
+        rate = frameRate(s.div, ppm)/1000.0;
+
+        /* SOF: BitClk counts of the last ms. */
+        count += (running) ? rate*I2S_CLOCK_FACTOR : 0.0;
+        mockBitClkCount = (uint32)count;
+        count -= mockBitClkCount;
+        FreqCapt();
+
+        /* DMAs. */
+        if (running) {
+            fill -= rate;
+            res->ok &= ((fill >= 0.0) || (t < RUN_MS/3u)) ? 1u : 0u;
+            fill = fmax(fill, 0.0);
+        }
+
+        /* Receive stage, up to DELAY_MS after the SOF. */
+        acc += c->fs/1000.0;
+        frames = (uint16)acc;
+        acc -= frames;
+        fill += frames;
+        res->ok &= ((fill <= bufferSize) || (t < RUN_MS/3u)) ? 1u : 0u;
+        fill = fmin(fill, bufferSize);
+        dist = (uint16)lrint(fmax((running) ? fill - rate*DELAY_MS*urand() : fill, 0.0));
+        servoUpdateAverage(&s, dist);
+        if (!running && (dist >= servoStartLevel(&s))) {
+            running = 1u;
+            servoResetAverage(&s, dist);
+            restartBitClkMeasure();
+            servoTime = t;
+        }
+
+        /* Servo. */
+        if (running) {
+            if (pi && (t - servoTime >= SERVO_PI_PERIOD_MS)) {
+                servoTime += SERVO_PI_PERIOD_MS;
+                freq = getBitClkFrequency(&seq);
+                (void)servoControl(&s, freq, seq != lastSeq);
+                lastSeq = seq;
+            } else if (!pi && (0u == t % adjustInterval)) {
+                freq = getBitClkFrequency(&seq);
+                (void)servoAdjust(&s, freq, seq != lastSeq);
+                lastSeq = seq;
+            }
+        }
+
+        /* Lock and statistics. */
+        err = (frameRate(s.div, ppm)/c->fs - 1.0)*1e6;
+        if (fabs(err) < LOCK_PPM) {
+            okSince = (RUN_MS == okSince) ? t : okSince;
+        } else {
+            okSince = RUN_MS;
+        }
+        if ((res->lock < 0.0) && (RUN_MS != okSince) && (t - okSince >= LOCK_HOLD_MS)) {
+            res->lock = okSince/1000.0;
+        }
+        if (t >= RUN_MS/3u) {
+            f = fill - s.target;
+            sumP += err;
+            sumP2 += err*err;
+            sumF += f;
+            sumF2 += f*f;
+            n++;
+        }
+    }
+
+    res->ppmStd = sqrt(fmax(sumP2/n - (sumP/n)*(sumP/n), 0.0));
+    res->fillMean = sumF/n;
+    res->fillStd = sqrt(fmax(sumF2/n - (sumF/n)*(sumF/n), 0.0));
+}
+
+int main(void) {
+    static const PI_CASE cases[] = {
+        {48000u, 300.0, 0.0, 0.0},
+        {48000u, 3000.0, 0.0, 0.0},
+        {44100u, 3000.0, 0.0, 0.0},
+        {96000u, 12000.0, 0.0, 0.0},
+        {48000u, 3000.0, 0.02, 5.0},
+        {44100u, -8000.0, -0.02, 10.0}
+    };
+    PI_RESULT band;
+    PI_RESULT pi;
+    double fs;
+    uint8 i;
+
+    initDMAs();
+    printf("                               three band                 PI (%umHz, zeta %u/1000)\n",
+           SERVO_PI_BANDWIDTH_MHZ, SERVO_PI_DAMPING);
+    printf("     fs   offset drift wobble  lock   ppm std  fill mean/std   lock   ppm std  fill mean/std\n");
+    for (i = 0u; i < sizeof(cases)/sizeof(cases[0]); i++) {
+        fs = cases[i].fs;
+        runCase(&cases[i], 0u, &band);
+        runCase(&cases[i], 1u, &pi);
+        printf("  %6lu %+7.0f %5.2f %5.0f  %5.1fs %6.2f  %+7.1f %5.1f   %5.1fs %6.2f  %+7.1f %5.1f\n",
+               (unsigned long)cases[i].fs, cases[i].ppm, cases[i].drift, cases[i].wobble, band.lock, band.ppmStd,
+               band.fillMean, band.fillStd, pi.lock, pi.ppmStd, pi.fillMean, pi.fillStd);
+
+        TEST_CHECK(band.ok && pi.ok, "case %u: ring ran dry or full (three band %u, PI %u)", i, band.ok, pi.ok);
+        TEST_CHECK((band.lock >= 0.0) && (pi.lock >= 0.0) && (pi.lock <= band.lock*PI_LOCK_RATIO),
+                   "case %u: PI locked after %.1fs, three band after %.1fs", i, pi.lock, band.lock);
+        TEST_CHECK((fabs(pi.fillMean) <= PI_FILL_FRAMES) && (fabs(pi.fillMean) <= fabs(band.fillMean) + 1.0),
+                   "case %u: PI fill %+.1f frames from the target, three band %+.1f", i, pi.fillMean,
+                   band.fillMean);
+        TEST_CHECK(pi.ppmStd <= band.ppmStd + PI_WANDER_PPM, "case %u: PI wanders %.2fppm, three band %.2fppm",
+                   i, pi.ppmStd, band.ppmStd);
+    }
+
+    return testResult("test_servo_pi");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,128 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Divider offsets learned per sampling rate. One servo runs through the host
+* switching 44.1/48/96/88.2kHz twice, with the source clock off by a fixed
+* offset and the buffered data size held at the target, stepped as in
+* main.c. The lock time of each switch is the time from which the BitClk
+* stays within LOCK_PPM of fs.
+*  - The first rate starts cold, from the nominal divider.
+*  - The rates after it start from the trim, the second round from the
+*    offsets learned for them. Both have to lock within SEED_LIMIT_MS.
+*  - With more than SERVO_RATES rates, the entry learned first is reused.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "clock_servo.h"
+#include "test.h"
+#include <math.h>
+#include <string.h>
+
+#define LOCK_PPM        (10.0)
+#define SEED_LIMIT_MS   (100u)
+#define SWITCH_MS       (20000u)
+#define ROUNDS          (2u)
+
+/* FracDiv output [Hz] for divider value div and source offset ppm. */
+static double fracDivOut(uint32 div, double ppm) {
+    return DIVIDER_SOURCE_FREQ*(1.0 + ppm*1e-6)*((double)div/div_MAX);
+}
+
+/*******************************************************************************
+*  Switch s to fs and run it for SWITCH_MS with offset ppm. Returns the lock
+*  time [ms], or SWITCH_MS when the BitClk never stays within LOCK_PPM.
+*******************************************************************************/
+static uint32 runRate(CLOCK_SERVO *s, uint32 fs, double ppm) {
+    double count = 0.0;
+    uint32 seq = 0u;
+    uint32 lastSeq = 0u;
+    uint32 lock = SWITCH_MS;
+    uint32 freq;
+    uint32 t;
+
+    setLatencyProfile(LATENCY_PROFILE_DEEP, fs);
+    servoSetRate(s, fs);
+    servoResetAverage(s, s->target);
+    restartBitClkMeasure();
+
+    for (t = 1u; t <= SWITCH_MS; t++) {
+        /* USB SOF: capture the counts of the last ms. */
+        count += fracDivOut(s->div, ppm)/1000.0;
+        mockBitClkCount = (uint32)count;
+        count -= mockBitClkCount;
+        FreqCapt();
+
+#if (SERVO_PI_CONTROL)
+        if (0u == t % SERVO_PI_PERIOD_MS) {
+            freq = getBitClkFrequency(&seq);
+            (void)servoControl(s, freq, seq != lastSeq);
+            lastSeq = seq;
+        }
+#else
+        if (0u == t % adjustInterval) {
+            freq = getBitClkFrequency(&seq);
+            (void)servoAdjust(s, freq, seq != lastSeq);
+            lastSeq = seq;
+        }
+#endif
+
+        if (fabs(fracDivOut(s->div, ppm)/I2S_CLOCK_FACTOR/fs - 1.0)*1e6 < LOCK_PPM) {
+            lock = (SWITCH_MS == lock) ? t : lock;
+        } else {
+            lock = SWITCH_MS;
+        }
+    }
+
+    return lock;
+}
+
+int main(void) {
+    static const uint32 rates[] = {44100u, 48000u, 96000u, 88200u};
+    static const uint32 more[SERVO_RATES + 1u] = {44100u, 48000u, 88200u, 96000u, 32000u, 22050u, 24000u, 16000u,
+                                                  11025u};
+    static const double offsets[] = {300.0, -3000.0, 8000.0, -12000.0};
+    CLOCK_SERVO s;
+    uint32 lock;
+    uint8 found;
+    uint8 o;
+    uint8 n;
+    uint8 r;
+    uint8 i;
+
+    initDMAs();
+    printf("lock time [s] after each switch, 44.1/48/96/88.2kHz twice\n");
+    for (o = 0u; o < sizeof(offsets)/sizeof(offsets[0]); o++) {
+        memset(&s, 0, sizeof(s));
+        printf("  %+7.0fppm:", offsets[o]);
+        for (n = 0u; n < ROUNDS; n++) {
+            for (r = 0u; r < sizeof(rates)/sizeof(rates[0]); r++) {
+                lock = runRate(&s, rates[r], offsets[o]);
+                printf(" %5.2f", lock/1000.0);
+                TEST_CHECK(lock < SWITCH_MS, "%lu Hz %+.0fppm: no lock", (unsigned long)rates[r], offsets[o]);
+                if ((0u != n) || (0u != r)) {
+                    TEST_CHECK(lock <= SEED_LIMIT_MS, "%lu Hz %+.0fppm round %u: locked after %lu ms",
+                               (unsigned long)rates[r], offsets[o], n + 1u, (unsigned long)lock);
+                }
+            }
+            printf((0u == n) ? " /" : "\n");
+        }
+    }
+
+    /* One rate more than the table holds: the entry of the first one is reused. */
+    memset(&s, 0, sizeof(s));
+    for (r = 0u; r < sizeof(more)/sizeof(more[0]); r++) {
+        (void)runRate(&s, more[r], 500.0);
+    }
+    for (r = 0u; r < sizeof(more)/sizeof(more[0]); r++) {
+        found = 0u;
+        for (i = 0u; i < SERVO_RATES; i++) {
+            found |= (more[r] == s.rates[i].fs) ? 1u : 0u;
+        }
+        TEST_CHECK(found == ((0u != r) ? 1u : 0u), "%lu Hz: %s in the table", (unsigned long)more[r],
+                   (0u != found) ? "still" : "not");
+    }
+
+    return testResult("test_servo_rates");
+}
+
+/* [] END OF FILE */
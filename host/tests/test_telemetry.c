@@ -0,0 +1,164 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* EZI2C snapshot seqlock and history pages of telemetry.c.
+*  - Snapshot: two updates are written as main.c does, between
+*    TELEMETRY_BEGIN() and TELEMETRY_END(), every field from the same
+*    counter, and the buffer is recorded after each store. A PC read goes
+*    from low to high addresses, so it gets a run of bytes from one recorded
+*    state, then from the same or a later one, and so on. Every read made of
+*    up to three runs is checked: if seqDone equals seqStart, all fields must
+*    come from the same update. Also across the 8-bit sequence wrap.
+*  - History: serveHistoryPage() copies the requested page with the capture
+*    count, publishes pageReady and clears historyPage. Invalid pages are
+*    left alone.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "telemetry.h"
+#include "test.h"
+#include <string.h>
+
+#define UPDATES         (2u)
+#define STATES          (1u + UPDATES*18u)
+#define BUF_SIZE        (offsetof(struct _EZI2C_buf, pageReady))
+
+static uint8 state[STATES][BUF_SIZE];
+static uint8 states;
+
+static void record(void) {
+    memcpy(state[states++], &EZI2C_buf, BUF_SIZE);
+}
+
+#define STORE(field, v)     {EZI2C_buf.field = (v); record();}
+
+/* The snapshot update of main.c, each field set from v. */
+static void update(uint32 v) {
+    TELEMETRY_BEGIN();
+    record();
+    STORE(numOfBuffers, (uint8)v);
+    STORE(latency, (uint16)v);
+    STORE(bitClkFreqency, v);
+    STORE(div, v);
+    STORE(dist, (uint16)v);
+    STORE(distAvrerage, (uint16)v);
+    STORE(distTarget, (uint16)v);
+    STORE(jitter, (uint16)v);
+    STORE(clockAdjust, (int16)v);
+    STORE(inOutDiffVDAC, (int16)v);
+    STORE(inOutDiffI2S, (int16)v);
+    STORE(L, (uint8)v);
+    STORE(R, (uint8)v);
+    STORE(flag, (uint8)v);
+    TELEMETRY_END();
+    record();
+}
+
+/* Whether every field of read b comes from the same update. */
+static uint8 consistent(const struct _EZI2C_buf *b) {
+    uint32 v = b->div;
+
+    return (b->bitClkFreqency == v) && (b->numOfBuffers == (uint8)v) && (b->latency == (uint16)v) &&
+           (b->dist == (uint16)v) && (b->distAvrerage == (uint16)v) && (b->distTarget == (uint16)v) &&
+           (b->jitter == (uint16)v) && (b->clockAdjust == (int16)v) && (b->inOutDiffVDAC == (int16)v) &&
+           (b->inOutDiffI2S == (int16)v) && (b->L == (uint8)v) && (b->R == (uint8)v) && (b->flag == (uint8)v);
+}
+
+/*******************************************************************************
+*  Check every read of up to three runs over two updates starting from value
+*  v and sequence seq. Returns the number of reads accepted.
+*******************************************************************************/
+static uint32 checkReads(uint32 v, uint8 seq, uint32 *rejected) {
+    union {
+        struct _EZI2C_buf b;
+        uint8 bytes[sizeof(struct _EZI2C_buf)];
+    } rd;
+    uint32 accepted = 0u;
+    uint16 p;
+    uint16 q;
+    uint8 i;
+    uint8 j;
+    uint8 k;
+
+    /* Start from a consistent buffer. */
+    memset(&EZI2C_buf, 0, sizeof(EZI2C_buf));
+    EZI2C_buf.seqStart = seq;
+    states = 0u;
+    update(v - 1u);
+    states = 0u;
+    record();
+    update(v);
+    update(v + 1u);
+
+    memset(&rd, 0, sizeof(rd));
+    for (i = 0u; i < states; i++) {
+        for (j = i; j < states; j++) {
+            for (k = j; k < states; k++) {
+                for (p = 0u; p <= BUF_SIZE; p++) {
+                    for (q = p; q <= BUF_SIZE; q++) {
+                        memcpy(rd.bytes, state[i], p);
+                        memcpy(rd.bytes + p, state[j] + p, q - p);
+                        memcpy(rd.bytes + q, state[k] + q, BUF_SIZE - q);
+                        if (rd.b.seqDone != rd.b.seqStart) {
+                            (*rejected)++;
+                            continue;
+                        }
+                        accepted++;
+                        TEST_CHECK(consistent(&rd.b), "torn read: states %u/%u/%u split at %u/%u", i, j, k, p, q);
+                    }
+                }
+            }
+        }
+    }
+    return accepted;
+}
+
+int main(void) {
+    TELEMETRY_ENTRY *e;
+    uint32 accepted = 0u;
+    uint32 rejected = 0u;
+    uint16 n;
+    uint8 page;
+
+    initTelemetry();
+
+    /* Snapshot. */
+    accepted += checkReads(0x12345678u, 0x10u, &rejected);
+    accepted += checkReads(0x89ABCDEFu, 0xFEu, &rejected);
+    printf("snapshot reads: %lu accepted, %lu rejected\n", (unsigned long)accepted, (unsigned long)rejected);
+    TEST_CHECK(0u != rejected, "no read overlapped an update");
+
+    /* History: entry n holds n in every field. */
+    for (n = 0u; n < TELEMETRY_HISTORY + 40u; n++) {
+        e = NULL;
+        for (page = 0u; (NULL == e) && (page < TELEMETRY_INTERVAL); page++) {
+            e = telemetryDue(1u);
+        }
+        TEST_CHECK(NULL != e, "no entry due after %u packets", TELEMETRY_INTERVAL);
+        e->div = n;
+        e->dist = n;
+    }
+    for (page = 0u; page < TELEMETRY_PAGES; page++) {
+        EZI2C_buf.historyPage = page;
+        serveHistoryPage();
+        TEST_CHECK(TELEMETRY_NO_PAGE == EZI2C_buf.historyPage, "page %u: request not cleared", page);
+        TEST_CHECK(page == EZI2C_buf.pageReady, "page %u: pageReady %u", page, EZI2C_buf.pageReady);
+        TEST_CHECK(TELEMETRY_HISTORY + 40u == EZI2C_buf.historyCount, "page %u: count %u", page,
+                   EZI2C_buf.historyCount);
+        for (n = 0u; n < TELEMETRY_PAGE_ENTRIES; n++) {
+            uint16 idx = page*TELEMETRY_PAGE_ENTRIES + n;
+            uint16 want = (idx < 40u) ? (uint16)(idx + TELEMETRY_HISTORY) : idx;
+
+            TEST_CHECK((want == EZI2C_buf.page[n].div) && (want == EZI2C_buf.page[n].dist),
+                       "page %u entry %u: %lu, expected %u", page, n, (unsigned long)EZI2C_buf.page[n].div, want);
+        }
+    }
+    EZI2C_buf.historyPage = TELEMETRY_PAGES;
+    EZI2C_buf.pageReady = 3u;
+    serveHistoryPage();
+    TEST_CHECK((TELEMETRY_PAGES == EZI2C_buf.historyPage) && (3u == EZI2C_buf.pageReady), "invalid page served");
+
+    return testResult("test_telemetry");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,173 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* VDAC requantization (built with VDAC_NOISE_SHAPING set). A 997Hz sine goes
+* through writeAudioBuffers() as 16-bit packets, and the in-band (20Hz-20kHz)
+* SNR of soundBuffer_L, distortion included, is taken from a Hann windowed
+* FFT of the error against the input. The same is done for the truncation the
+* build without the switch uses.
+*  - At 88.2kHz and above the shaper has to beat truncation by SHAPED_GAIN_DB
+*    at every level.
+*  - Below 88.2kHz, where dither alone would lose SNR, the samples have to be
+*    truncated as in the build without the switch, code for code.
+*  - A full scale sine must not drive the error feedback unstable.
+*
+*******************************************************************************/
+#include <mock_psoc.h>
+#include "audio_path.h"
+#include "test.h"
+#include <complex.h>
+#include <math.h>
+#include <string.h>
+
+#define FFT_SIZE        (65536u)
+#define WARMUP_FRAMES   (4096u)
+#define PACKET_FRAMES   (48u)
+#define TONE_HZ         (997.0)
+#define SHAPED_GAIN_DB  (4.0)
+
+static double input[FFT_SIZE];
+static double shaped[FFT_SIZE];
+static double truncated[FFT_SIZE];
+static double complex spectrum[FFT_SIZE];
+
+/* In-place radix-2 FFT of spectrum[0..n-1]. */
+static void fft(uint32 n) {
+    double complex t;
+    double complex w;
+    double complex wn;
+    uint32 len;
+    uint32 i;
+    uint32 j;
+    uint32 k;
+    uint32 b;
+
+    for (i = 1u, j = 0u; i < n; i++) {
+        for (b = n >> 1; 0u != (j & b); b >>= 1) {
+            j ^= b;
+        }
+        j ^= b;
+        if (i < j) {
+            t = spectrum[i];
+            spectrum[i] = spectrum[j];
+            spectrum[j] = t;
+        }
+    }
+    for (len = 2u; len <= n; len <<= 1) {
+        w = cexp(-2.0*M_PI*I/len);
+        for (i = 0u; i < n; i += len) {
+            wn = 1.0;
+            for (k = 0u; k < len/2u; k++) {
+                t = spectrum[i + k + len/2u]*wn;
+                spectrum[i + k + len/2u] = spectrum[i + k] - t;
+                spectrum[i + k] += t;
+                wn *= w;
+            }
+        }
+    }
+}
+
+/* Windowed energy of x (or of x - ref) over f0..f1 [Hz]. */
+static double bandEnergy(const double *x, const double *ref, double fs, double f0, double f1) {
+    double e = 0.0;
+    uint32 i;
+
+    for (i = 0u; i < FFT_SIZE; i++) {
+        spectrum[i] = (x[i] - ((NULL != ref) ? ref[i] : 0.0))*(0.5 - 0.5*cos(2.0*M_PI*i/FFT_SIZE));
+    }
+    fft(FFT_SIZE);
+    for (i = 1u; i < FFT_SIZE/2u; i++) {
+        if ((i*fs/FFT_SIZE > f0) && (i*fs/FFT_SIZE < f1)) {
+            e += creal(spectrum[i])*creal(spectrum[i]) + cimag(spectrum[i])*cimag(spectrum[i]);
+        }
+    }
+    return e;
+}
+
+/*******************************************************************************
+*  Send a sine of amplitude amp [full scale] at fs, and record the input and
+*  the VDAC_L codes, both in 16-bit LSB.
+*******************************************************************************/
+static void runTone(uint32 fs, double amp) {
+    static uint8 packet[PACKET_FRAMES*AUDIO_CH*2u] CY_ALIGN(4);
+    uint32 pos = 0u;
+    uint16 idx;
+    int16 s;
+    uint8 f;
+
+    setAudioFormat(ALT_SETTING_16BIT);
+    setLatencyProfile(LATENCY_PROFILE_DEEP, fs);
+    setVdacShaper(fs);
+
+    while (pos < WARMUP_FRAMES + FFT_SIZE) {
+        for (f = 0u; f < PACKET_FRAMES; f++) {
+            s = (int16)lrint(amp*32767.0*sin(2.0*M_PI*TONE_HZ*(pos + f)/fs));
+            packet[4u*f + 0u] = (uint8)s;
+            packet[4u*f + 1u] = (uint8)((uint16)s >> 8);
+            packet[4u*f + 2u] = packet[4u*f + 0u];
+            packet[4u*f + 3u] = packet[4u*f + 1u];
+            if ((pos + f >= WARMUP_FRAMES) && (pos + f < WARMUP_FRAMES + FFT_SIZE)) {
+                input[pos + f - WARMUP_FRAMES] = s;
+                truncated[pos + f - WARMUP_FRAMES] = (double)(s >> 8)*256.0;
+            }
+        }
+        idx = ringHeadIndex(&soundRing);
+        TEST_CHECK(1u == writeAudioBuffers(packet, sizeof(packet)), "packet dropped");
+        for (f = 0u; f < PACKET_FRAMES; f++, idx = (idx + 1u) & soundRing.mask) {
+            if ((pos + f >= WARMUP_FRAMES) && (pos + f < WARMUP_FRAMES + FFT_SIZE)) {
+                shaped[pos + f - WARMUP_FRAMES] = ((int32)soundBuffer_L[idx] - 128)*256.0;
+            }
+        }
+        ringRelease(&soundRing, PACKET_FRAMES);
+        pos += PACKET_FRAMES;
+    }
+}
+
+/* In-band SNR [dB] of out against the input. */
+static double snr(const double *out, double fs) {
+    return 10.0*log10(bandEnergy(input, NULL, fs, 20.0, 20000.0)/bandEnergy(out, input, fs, 20.0, 20000.0));
+}
+
+int main(void) {
+    static const uint32 rates[] = {44100u, 48000u, 88200u, 96000u, 176400u, 192000u};
+    static const double amps[] = {0.9, 0.5, 0.01};
+    double sTrunc;
+    double sShaped;
+    uint32 differ;
+    uint32 i;
+    uint8 a;
+    uint8 r;
+
+    initDMAs();
+    printf("in-band SNR [dB], truncation -> build with the switch, at 0.9/0.5/0.01 full scale\n");
+    for (r = 0u; r < sizeof(rates)/sizeof(rates[0]); r++) {
+        printf("  %6lu Hz:", (unsigned long)rates[r]);
+        for (a = 0u; a < sizeof(amps)/sizeof(amps[0]); a++) {
+            runTone(rates[r], amps[a]);
+            sTrunc = snr(truncated, rates[r]);
+            sShaped = snr(shaped, rates[r]);
+            printf("  %5.1f -> %5.1f", sTrunc, sShaped);
+            if (rates[r] >= 88200u) {
+                TEST_CHECK(sShaped >= sTrunc + SHAPED_GAIN_DB, "%lu Hz %.2f FS: shaper %.1f dB, truncation %.1f dB",
+                           (unsigned long)rates[r], amps[a], sShaped, sTrunc);
+            } else {
+                for (i = 0u, differ = 0u; i < FFT_SIZE; i++) {
+                    differ += (shaped[i] == truncated[i]) ? 0u : 1u;
+                }
+                TEST_CHECK(0u == differ, "%lu Hz %.2f FS: %lu codes differ from truncation",
+                           (unsigned long)rates[r], amps[a], (unsigned long)differ);
+            }
+        }
+        printf("\n");
+    }
+
+    /* Full scale: clipping must not make the loop run away. */
+    runTone(96000u, 1.0);
+    sShaped = snr(shaped, 96000.0);
+    printf("96kHz full scale: %.1f dB\n", sShaped);
+    TEST_CHECK(sShaped >= 40.0, "96kHz full scale: %.1f dB, the error feedback is unstable", sShaped);
+
+    return testResult("test_vdac_shaper");
+}
+
+/* [] END OF FILE */
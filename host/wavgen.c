@@ -0,0 +1,85 @@
+/*******************************************************************************
+* Host build of USB_Audio_PSoC5LP_I2S
+*
+* Test vector generator. Writes a deterministic stereo WAV file: a 997Hz sine
+* on the left channel and a 3kHz sine plus LCG noise on the right, both at
+* -1dBFS, so every bit of each sample depth is exercised and the channels
+* cannot be swapped unnoticed.
+*
+* Usage: wavgen fs bits ms out.wav
+*
+*******************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static void put16(FILE *f, uint32_t v) {
+    fputc((int)(v & 0xFFu), f);
+    fputc((int)((v >> 8) & 0xFFu), f);
+}
+
+static void put32(FILE *f, uint32_t v) {
+    put16(f, v & 0xFFFFu);
+    put16(f, v >> 16);
+}
+
+int main(int argc, char **argv) {
+    const double amp = 0.891*2147483647.0;
+    uint32_t fs;
+    uint32_t bits;
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t seed = 1u;
+    uint32_t i;
+    uint32_t b;
+    int32_t s[2];
+    int k;
+    FILE *f;
+
+    if (argc != 5) {
+        fprintf(stderr, "usage: wavgen fs bits ms out.wav\n");
+        return 2;
+    }
+    fs = (uint32_t)atol(argv[1]);
+    bits = (uint32_t)atol(argv[2]);
+    frames = (uint32_t)((uint64_t)fs*(uint32_t)atol(argv[3])/1000u);
+    if (((16u != bits) && (24u != bits) && (32u != bits)) || (0u == frames)) {
+        fprintf(stderr, "wavgen: bits must be 16, 24 or 32\n");
+        return 2;
+    }
+    bytes = frames*2u*(bits/8u);
+
+    f = fopen(argv[4], "wb");
+    if (NULL == f) {
+        perror(argv[4]);
+        return 2;
+    }
+    fputs("RIFF", f);
+    put32(f, 36u + bytes);
+    fputs("WAVEfmt ", f);
+    put32(f, 16u);
+    put16(f, 1u);
+    put16(f, 2u);
+    put32(f, fs);
+    put32(f, fs*2u*(bits/8u));
+    put16(f, 2u*(bits/8u));
+    put16(f, bits);
+    fputs("data", f);
+    put32(f, bytes);
+
+    for (i = 0u; i < frames; i++) {
+        seed = seed*1664525u + 1013904223u;
+        s[0] = (int32_t)lrint(amp*sin(2.0*M_PI*997.0*i/fs));
+        s[1] = (int32_t)lrint(0.9*amp*sin(2.0*M_PI*3000.0*i/fs)) + ((int32_t)seed >> 4);
+        for (k = 0; k < 2; k++) {
+            for (b = 32u - bits; b < 32u; b += 8u) {
+                fputc((int)(((uint32_t)s[k] >> b) & 0xFFu), f);
+            }
+        }
+    }
+
+    return (0 == fclose(f)) ? 0 : 2;
+}
+
+/* [] END OF FILE */
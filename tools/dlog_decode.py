@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Decode the binary debug log of USB_Audio_PSoC5LP_I2S into text.
+
+The firmware (debug_log.c) sends records of
+    DLOG_SYNC, id, argc, timestamp (uint32), argc x uint32
+little endian over the DP UART. The format strings are read from the
+DLOG_FORMATS table of debug_log.h, so the decoder always matches the tree
+the firmware was built from.
+
+Usage:
+    dlog_decode.py [-f debug_log.h] [-b 115200] [-t] [input]
+
+input is a serial port (set to raw mode at the given baud rate), a captured
+file, or stdin when omitted. -t prefixes each line with the time in seconds
+of its first record, derived from the bus clock logged by DLOG_CLOCK.
+"""
+
+import argparse
+import ast
+import os
+import re
+import struct
+import sys
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      '..', 'USB_Audio_PSoC5LP_I2S.cydsn', 'debug_log.h')
+
+DLOG_SYNC = 0xA5
+HEADER_SIZE = 7
+CONVERSION = re.compile(r'%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l)?([diouxXcs%])')
+
+
+def load_formats(path):
+    """Return the format strings of DLOG_FORMATS in id order."""
+    with open(path) as f:
+        text = f.read()
+    start = text.index('#define DLOG_FORMATS(X)')
+    end = text.index('\n\n', start)
+    table = text[start:end].replace('\\\n', '\n')
+    formats = []
+    for m in re.finditer(r'X\(\s*(\w+)\s*,((?:\s*"(?:[^"\\]|\\.)*")+)\s*\)', table):
+        parts = re.findall(r'"(?:[^"\\]|\\.)*"', m.group(2))
+        formats.append(''.join(ast.literal_eval(p) for p in parts))
+    names = re.findall(r'X\(\s*(\w+)\s*,', table)
+    return names, formats
+
+
+def render(fmt, args):
+    """printf fmt with 32-bit arguments, signed for %d/%i."""
+    values = []
+    it = iter(args)
+    for m in CONVERSION.finditer(fmt):
+        kind = m.group(1)
+        if kind == '%':
+            continue
+        v = next(it, 0)
+        if kind in 'di' and v >= 0x80000000:
+            v -= 0x100000000
+        values.append(v)
+    py = re.sub(r'(%[-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l)?u', r'\1d', fmt)
+    py = re.sub(r'(%[-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l)([dioxXcs])', r'\1\2', py)
+    return py % tuple(values)
+
+
+def open_input(path, baud):
+    if path is None:
+        return sys.stdin.buffer
+    f = open(path, 'rb', buffering=0)
+    if os.isatty(f.fileno()):
+        import termios
+        import tty
+        tty.setraw(f.fileno())
+        attr = termios.tcgetattr(f.fileno())
+        speed = getattr(termios, 'B%d' % baud)
+        attr[4] = attr[5] = speed
+        termios.tcsetattr(f.fileno(), termios.TCSANOW, attr)
+    return f
+
+
+def decode(stream, names, formats, timestamps, out):
+    buf = bytearray()
+    clock = None
+    last = None
+    high = 0
+    line_start = True
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        buf += chunk
+        while len(buf) >= HEADER_SIZE:
+            if buf[0] != DLOG_SYNC:
+                del buf[0]
+                continue
+            rid, argc = buf[1], buf[2]
+            if rid >= len(formats) or argc > 4:
+                del buf[0]
+                continue
+            size = HEADER_SIZE + 4 * argc
+            if len(buf) < size:
+                break
+            ts, = struct.unpack_from('<I', buf, 3)
+            args = struct.unpack_from('<%dI' % argc, buf, HEADER_SIZE)
+            del buf[:size]
+
+            # Unwrap the 32-bit cycle counter.
+            if last is not None and ts < last:
+                high += 1 << 32
+            last = ts
+            if names[rid] == 'DLOG_CLOCK' and argc:
+                clock = args[0]
+
+            text = render(formats[rid], args)
+            if timestamps and clock:
+                # Stamp records that start a line.
+                body = text.lstrip('\n')
+                if body and (line_start or len(body) < len(text)):
+                    text = '%s[%12.6f] %s' % (text[:len(text) - len(body)], (high + ts) / clock, body)
+            if text:
+                line_start = text.endswith('\n')
+            out.write(text)
+            out.flush()
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    p.add_argument('input', nargs='?', help='serial port or capture file')
+    p.add_argument('-f', '--formats', default=HEADER, help='debug_log.h')
+    p.add_argument('-b', '--baud', type=int, default=115200)
+    p.add_argument('-t', '--time', action='store_true', help='print timestamps')
+    a = p.parse_args()
+
+    names, formats = load_formats(a.formats)
+    try:
+        decode(open_input(a.input, a.baud), names, formats, a.time, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()